@@ -14,6 +14,17 @@ foreach ($i in 'A','B','C','D') {
 	$SpeechSynthesizer.Speak($i)
 }
 
+# Clips for DFR0534Composer::ENGLISH (not part of content.txt)
+foreach ($i in 30,40,50,60,70,80,90) {
+	$SpeechSynthesizer.SetOutputToWaveFile((get-location).Path+"\ZH\$i.wav",$streamFormat)
+	$SpeechSynthesizer.Speak($i)
+}
+
+foreach ($clip in @(@('HU','hundred'),@('TH','thousand'),@('MI','minus'),@('PT','point'),@('OC','o''clock'),@('OH','oh'))) {
+	$SpeechSynthesizer.SetOutputToWaveFile((get-location).Path+'\ZH\'+$clip[0]+'.wav',$streamFormat)
+	$SpeechSynthesizer.Speak($clip[1])
+}
+
 
 $SpeechSynthesizer.SetOutputToWaveFile((get-location).Path+"\test.wav",$streamFormat)
 $SpeechSynthesizer.Speak("Test")
@@ -0,0 +1,200 @@
+/*
+ * Benchmark for the DFR0534 functions on real hardware
+ *
+ * Measures with micros() how long each request and command blocks the loop and
+ * compares it with the time the frames need on the wire at 9600 baud. The results
+ * are written as CSV to Serial (115200 baud), so runs on different boards and
+ * library versions can be compared. Columns:
+ * - board, serial, library: Board type, SoftwareSerial or HardwareSerial, library version
+ * - command: DFR0534 function
+ * - runs, timeouts: Number of calls and failed calls (for example request timeout)
+ * - min_us, mean_us, max_us: Blocking time of the calls
+ * - jitter_us: Standard deviation of the blocking time
+ * - wire_us: Mean time of the sent and received bytes on the wire
+ *
+ * This example code works on Arduino Uno/Nano/ATmega328p with SoftwareSerial and
+ * on ESP32 with HardwareSerial. The audio module needs at least one audio file
+ * on the flash memory chip.
+ */
+
+#if !defined(ESP32)
+#include <SoftwareSerial.h>
+#endif
+#include <DFR0534.h>
+
+#define BENCHMARKRUNS 20
+#define BENCHMARKPAUSEMS 50
+
+#if defined(ESP32)
+#define TX_PIN 19
+#define RX_PIN 23
+HardwareSerial g_serial(1);
+#define BENCHMARKBOARD "ESP32"
+#define BENCHMARKSERIAL "HardwareSerial"
+#else
+#define TX_PIN A0
+#define RX_PIN A1
+SoftwareSerial g_serial(RX_PIN, TX_PIN);
+#define BENCHMARKBOARD "AVR"
+#define BENCHMARKSERIAL "SoftwareSerial"
+#endif
+
+// Stream between DFR0534 and the serial connection, which counts the bytes on the wire
+class CountingStream : public Stream {
+  public:
+    CountingStream(Stream &stream) { m_ptrStream = &stream; }
+    int available() { return m_ptrStream->available(); }
+    void flush() { m_ptrStream->flush(); }
+    int peek() { return m_ptrStream->peek(); }
+    int read() {
+      int data = m_ptrStream->read();
+      if (data >= 0) bytes++;
+      return data;
+    }
+    size_t write(uint8_t data) {
+      bytes++;
+      return m_ptrStream->write(data);
+    }
+    using Print::write;
+    unsigned long bytes = 0;
+  private:
+    Stream *m_ptrStream;
+};
+
+CountingStream g_counting(g_serial);
+DFR0534 g_audio(g_counting);
+
+enum COMMANDS {
+  GETSTATUS,
+  GETFILENUMBER,
+  GETFILENAME,
+  GETDURATION,
+  GETTOTALFILES,
+  GETFIRSTFILENUMBER,
+  GETTOTALFILESINDIRECTORY,
+  GETDRIVE,
+  GETDRIVESSTATES,
+  SETVOLUME,
+  SETEQUALIZER,
+  PREPAREFILEBYNUMBER,
+  PLAYFILEBYNUMBER,
+  STOP,
+  COMMANDCOUNT
+};
+
+// Print name of a command
+void printName(byte command) {
+  switch (command) {
+    case GETSTATUS: Serial.print(F("getStatus")); break;
+    case GETFILENUMBER: Serial.print(F("getFileNumber")); break;
+    case GETFILENAME: Serial.print(F("getFileName")); break;
+    case GETDURATION: Serial.print(F("getDuration")); break;
+    case GETTOTALFILES: Serial.print(F("getTotalFiles")); break;
+    case GETFIRSTFILENUMBER: Serial.print(F("getFirstFileNumberInCurrentDirectory")); break;
+    case GETTOTALFILESINDIRECTORY: Serial.print(F("getTotalFilesInCurrentDirectory")); break;
+    case GETDRIVE: Serial.print(F("getDrive")); break;
+    case GETDRIVESSTATES: Serial.print(F("getDrivesStates")); break;
+    case SETVOLUME: Serial.print(F("setVolume")); break;
+    case SETEQUALIZER: Serial.print(F("setEqualizer")); break;
+    case PREPAREFILEBYNUMBER: Serial.print(F("prepareFileByNumber")); break;
+    case PLAYFILEBYNUMBER: Serial.print(F("playFileByNumber")); break;
+    case STOP: Serial.print(F("stop")); break;
+  }
+}
+
+// Call a command and return false, when the call failed
+bool runCommand(byte command) {
+  char name[12];
+  byte hour, minute, second;
+  switch (command) {
+    case GETSTATUS: return (g_audio.getStatus() != DFR0534::STATUSUNKNOWN);
+    case GETFILENUMBER: return (g_audio.getFileNumber() > 0);
+    case GETFILENAME: return g_audio.getFileName(name);
+    case GETDURATION: return g_audio.getDuration(hour, minute, second);
+    case GETTOTALFILES: return (g_audio.getTotalFiles() >= 0);
+    case GETFIRSTFILENUMBER: return (g_audio.getFirstFileNumberInCurrentDirectory() >= 0);
+    case GETTOTALFILESINDIRECTORY: return (g_audio.getTotalFilesInCurrentDirectory() >= 0);
+    case GETDRIVE: return (g_audio.getDrive() != DFR0534::DRIVEUNKNOWN);
+    case GETDRIVESSTATES: return (g_audio.getDrivesStates() != DFR0534::DRIVEUNKNOWN);
+    case SETVOLUME: g_audio.setVolume(g_audio.getVolume()); return true;
+    case SETEQUALIZER: g_audio.setEqualizer(g_audio.getEqualizer()); return true;
+    case PREPAREFILEBYNUMBER: g_audio.prepareFileByNumber(1); return true;
+    case PLAYFILEBYNUMBER: g_audio.playFileByNumber(1); return true;
+    case STOP: g_audio.stop(); return true;
+  }
+  return false;
+}
+
+// Measure a command and print one CSV line
+void benchmark(byte command) {
+  unsigned long durationsUS[BENCHMARKRUNS];
+  unsigned long minUS = 0xffffffff;
+  unsigned long maxUS = 0;
+  unsigned long sumUS = 0;
+  unsigned long bytes = 0;
+  word timeouts = 0;
+
+  for (byte i=0;i<BENCHMARKRUNS;i++) {
+    delay(BENCHMARKPAUSEMS);
+    while (g_serial.available()) g_serial.read(); // Drop unexpected bytes
+    unsigned long startBytes = g_counting.bytes;
+    unsigned long startUS = micros();
+    bool ok = runCommand(command);
+    unsigned long durationUS = micros()-startUS;
+    durationsUS[i] = durationUS;
+    bytes += g_counting.bytes-startBytes;
+    if (!ok) timeouts++;
+    if (durationUS < minUS) minUS = durationUS;
+    if (durationUS > maxUS) maxUS = durationUS;
+    sumUS += durationUS;
+  }
+
+  unsigned long meanUS = sumUS/BENCHMARKRUNS;
+  float variance = 0;
+  for (byte i=0;i<BENCHMARKRUNS;i++) {
+    float deviation = (float)durationsUS[i]-meanUS;
+    variance += deviation*deviation;
+  }
+  variance /= BENCHMARKRUNS;
+  // 10 bits per byte at 9600 baud
+  unsigned long wireUS = (unsigned long)((float)bytes/BENCHMARKRUNS*10*1000000/9600);
+
+  Serial.print(F(BENCHMARKBOARD ","  BENCHMARKSERIAL "," DFR0534_VERSION ","));
+  printName(command);
+  Serial.print(',');
+  Serial.print(BENCHMARKRUNS);
+  Serial.print(',');
+  Serial.print(timeouts);
+  Serial.print(',');
+  Serial.print(minUS);
+  Serial.print(',');
+  Serial.print(meanUS);
+  Serial.print(',');
+  Serial.print(maxUS);
+  Serial.print(',');
+  Serial.print((unsigned long)sqrt(variance));
+  Serial.print(',');
+  Serial.println(wireUS);
+}
+
+void setup() {
+  // Serial for CSV output
+  Serial.begin(115200);
+  // Serial connection to the DFR0534 module
+#if defined(ESP32)
+  g_serial.begin(9600, SERIAL_8N1, RX_PIN, TX_PIN);
+#else
+  g_serial.begin(9600);
+#endif
+
+  // Time for the audio module to start
+  delay(1000);
+  // Requests like getFileName() need a current file
+  g_audio.playFileByNumber(1);
+
+  Serial.println(F("board,serial,library,command,runs,timeouts,min_us,mean_us,max_us,jitter_us,wire_us"));
+  for (byte command=0;command<COMMANDCOUNT;command++) benchmark(command);
+}
+
+void loop() {
+}
@@ -38,8 +38,10 @@ void setup() {
    * /ZH/02.wav
    * /ZH/01.wav
    * /ZH/0A.wav
+   *
+   * F() keeps the list in flash memory instead of RAM
    */
-  g_audio.playCombined("05040302010A");
+  g_audio.playCombined(F("05040302010A"));
 }
 
 void loop() {
@@ -47,8 +47,8 @@ void setup() {
    * https://github.com/codingABI/DFR0534/tree/main/assets/exampleContent
    */
 
-  // Play the file "test.wav"
-  g_audio.playFileByName("/TEST    WAV");
+  // Play the file "test.wav" (F() keeps the path in flash memory instead of RAM)
+  g_audio.playFileByName(F("/TEST    WAV"));
 }
 
 void loop() {
@@ -0,0 +1,525 @@
+/**
+ * Program: dfr0534content
+ *
+ * Description:
+ * Linux command line tool to build a FAT image for the flash memory chip
+ * (W25Q64), an SD card or an USB drive of a DFR0534 audio module with a
+ * guaranteed "file copy order" and a C++ header with the file numbers,
+ * file names and durations
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Build:
+ *   g++ -O2 -o dfr0534content dfr0534content.cpp
+ *
+ * Usage:
+ *   dfr0534content [-s sizeMiB] manifest.txt content.img content.h
+ *
+ *   -s sizeMiB  Size of the image in MiB (1-2048, default 8 for the W25Q64)
+ *
+ * Manifest (one file per line, # starts a comment, paths without spaces):
+ *   <source file> <path on the drive> [<constant>]
+ *
+ *   test.wav   /TEST.WAV   TRACKTEST
+ *   ZH/01.wav  /ZH/01.WAV
+ *
+ * - Source files are relative to the directory of the manifest
+ * - Paths on the drive must be 8+3 names (upper case, no long file names)
+ *   and end with .WAV or .MP3
+ * - The files are written in the order of the manifest. The first file
+ *   gets file number 1. All files of a directory (including its subdirectories)
+ *   must be listed one after another, so the order of the directory entries
+ *   is the same as the "file copy order"
+ * - Without a constant the name is TRACK + the letters and digits of the path,
+ *   for example TRACKZH01 for /ZH/01.WAV
+ *
+ * The image is a FAT12/FAT16 file system without partition table. Write it
+ * with a flash programmer to the W25Q64 or with dd to a drive. The image
+ * contains no time stamps of the build, so the same manifest and the same
+ * source files always result in the same image.
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file dfr0534content.cpp
+ * @version 1.0.4
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+
+#define SECTORSIZE 512
+#define DIRENTRYSIZE 32
+#define ROOTENTRIES 512
+#define RESERVEDSECTORS 1
+#define FATCOUNT 2
+#define FAT12MAXCLUSTERS 4084
+#define FAT16MAXCLUSTERS 65524
+// Fixed date 2024-01-01 00:00:00 for all directory entries
+#define FATDATE (((2024-1980) << 9) | (1 << 5) | 1)
+#define FATTIME 0
+#define ATTRDIRECTORY 0x10
+#define ATTRARCHIVE 0x20
+
+// File from the manifest
+struct CONTENTFILE {
+  std::string source; // As in the manifest
+  std::string target;
+  std::string constant;
+  std::string shortName; // 11 chars directory entry name
+  int directory;
+  std::vector<unsigned char> data;
+  unsigned long durationMS;
+  unsigned long firstCluster;
+};
+
+// Directory on the drive
+struct CONTENTDIRECTORY {
+  std::string path;
+  std::string shortName;
+  int parent;
+  unsigned long firstCluster;
+  unsigned long clusters;
+  std::vector<unsigned char> entries;
+};
+
+// FAT geometry
+struct GEOMETRY {
+  unsigned long totalSectors;
+  unsigned long sectorsPerCluster;
+  unsigned long fatSectors;
+  unsigned long clusters;
+  int fatType;
+  unsigned long firstDataSector;
+};
+
+static void fail(const char *format, const char *text)
+{
+  fprintf(stderr, format, text);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+static bool readFile(const std::string &path, std::vector<unsigned char> &data)
+{
+  FILE *file = fopen(path.c_str(), "rb");
+  if (file == NULL) return false;
+  int c;
+  while ((c = fgetc(file)) != EOF) data.push_back(c);
+  fclose(file);
+  return true;
+}
+
+static unsigned long getLE(const std::vector<unsigned char> &data, size_t position, int bytes)
+{
+  unsigned long value = 0;
+  for (int i=bytes-1;i>=0;i--) value = (value << 8) | data[position+i];
+  return value;
+}
+
+static void setLE(unsigned char *buffer, unsigned long value, int bytes)
+{
+  for (int i=0;i<bytes;i++) {
+    buffer[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+// Duration of a WAV file from the fmt and data chunks
+static bool getWavDuration(const std::vector<unsigned char> &data, unsigned long &durationMS)
+{
+  if ((data.size() < 12) || (memcmp(&data[0], "RIFF", 4) != 0) || (memcmp(&data[8], "WAVE", 4) != 0)) return false;
+  unsigned long byteRate = 0;
+  size_t position = 12;
+  while (position+8 <= data.size()) {
+    unsigned long size = getLE(data, position+4, 4);
+    if ((memcmp(&data[position], "fmt ", 4) == 0) && (size >= 16) && (position+8+16 <= data.size())) {
+      byteRate = getLE(data, position+8+8, 4);
+    }
+    if (memcmp(&data[position], "data", 4) == 0) {
+      if (byteRate == 0) return false;
+      if (position+8+size > data.size()) size = data.size()-position-8;
+      durationMS = (unsigned long)((unsigned long long)size*1000/byteRate);
+      return true;
+    }
+    position += 8+size+(size & 1);
+  }
+  return false;
+}
+
+// Duration of a MP3 file as sum of all MPEG audio layer III frames
+static bool getMp3Duration(const std::vector<unsigned char> &data, unsigned long &durationMS)
+{
+  static const int bitrates[2][15] = {
+    { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 }, // MPEG 1
+    { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 } // MPEG 2 and 2.5
+  };
+  static const int sampleRates[3] = { 44100, 48000, 32000 };
+
+  size_t position = 0;
+  // Skip ID3v2 tag
+  if ((data.size() >= 10) && (memcmp(&data[0], "ID3", 3) == 0)) {
+    position = 10+((data[6] & 0x7f) << 21)+((data[7] & 0x7f) << 14)+((data[8] & 0x7f) << 7)+(data[9] & 0x7f);
+  }
+  unsigned long long samples = 0;
+  unsigned long frames = 0;
+  int sampleRate = 0;
+  while (position+4 <= data.size()) {
+    if ((data[position] != 0xff) || ((data[position+1] & 0xe0) != 0xe0)) {
+      position++;
+      continue;
+    }
+    int version = (data[position+1] >> 3) & 0x03; // 0 = 2.5, 2 = 2, 3 = 1
+    int layer = (data[position+1] >> 1) & 0x03; // 1 = layer III
+    int bitrateIndex = data[position+2] >> 4;
+    int sampleRateIndex = (data[position+2] >> 2) & 0x03;
+    int padding = (data[position+2] >> 1) & 0x01;
+    if ((version == 1) || (layer != 1) || (bitrateIndex == 0) || (bitrateIndex == 15) || (sampleRateIndex == 3)) {
+      position++;
+      continue;
+    }
+    sampleRate = sampleRates[sampleRateIndex] >> ((version == 3) ? 0 : (version == 2) ? 1 : 2);
+    int bitrate = bitrates[(version == 3) ? 0 : 1][bitrateIndex]*1000;
+    int frameSamples = (version == 3) ? 1152 : 576;
+    int frameLength = frameSamples/8*bitrate/sampleRate+padding;
+    samples += frameSamples;
+    frames++;
+    position += frameLength;
+  }
+  if (frames == 0) return false;
+  durationMS = (unsigned long)(samples*1000/sampleRate);
+  return true;
+}
+
+// Convert a name like "01.WAV" into the 11 chars of a directory entry
+static bool getShortName(const std::string &name, std::string &shortName, bool directory)
+{
+  static const char *allowed = "!#$%&'()-@^_`{}~";
+  size_t dot = name.find('.');
+  std::string base = name.substr(0, dot);
+  std::string extension = (dot == std::string::npos) ? "" : name.substr(dot+1);
+  if (base.empty() || (base.size() > 8) || (extension.size() > 3)) return false;
+  if (directory && !extension.empty()) return false;
+  if (extension.find('.') != std::string::npos) return false;
+  std::string chars = base+extension;
+  for (size_t i=0;i<chars.size();i++) {
+    unsigned char c = chars[i];
+    if (!isupper(c) && !isdigit(c) && (strchr(allowed, c) == NULL)) return false;
+  }
+  shortName = base+std::string(8-base.size(), ' ')+extension+std::string(3-extension.size(), ' ');
+  return true;
+}
+
+// Add a directory entry
+static void addEntry(std::vector<unsigned char> &entries, const std::string &shortName, unsigned char attributes, unsigned long cluster, unsigned long size)
+{
+  unsigned char entry[DIRENTRYSIZE];
+  memset(entry, 0, sizeof(entry));
+  memcpy(entry, shortName.c_str(), 11);
+  entry[11] = attributes;
+  setLE(&entry[14], FATTIME, 2);
+  setLE(&entry[16], FATDATE, 2);
+  setLE(&entry[18], FATDATE, 2);
+  setLE(&entry[22], FATTIME, 2);
+  setLE(&entry[24], FATDATE, 2);
+  setLE(&entry[26], cluster, 2);
+  setLE(&entry[28], size, 4);
+  entries.insert(entries.end(), entry, entry+DIRENTRYSIZE);
+}
+
+// Find the smallest cluster size for the image size
+static bool getGeometry(unsigned long sizeMiB, GEOMETRY &geometry)
+{
+  unsigned long rootSectors = ROOTENTRIES*DIRENTRYSIZE/SECTORSIZE;
+  geometry.totalSectors = sizeMiB*1024*1024/SECTORSIZE;
+  for (geometry.sectorsPerCluster=1;geometry.sectorsPerCluster<=64;geometry.sectorsPerCluster*=2) {
+    geometry.fatSectors = 1;
+    for (;;) {
+      unsigned long overhead = RESERVEDSECTORS+FATCOUNT*geometry.fatSectors+rootSectors;
+      geometry.clusters = (geometry.totalSectors-overhead)/geometry.sectorsPerCluster;
+      geometry.fatType = (geometry.clusters <= FAT12MAXCLUSTERS) ? 12 : 16;
+      unsigned long fatBytes = (geometry.fatType == 12) ? ((geometry.clusters+2)*3+1)/2 : (geometry.clusters+2)*2;
+      unsigned long fatSectors = (fatBytes+SECTORSIZE-1)/SECTORSIZE;
+      if (fatSectors <= geometry.fatSectors) break;
+      geometry.fatSectors = fatSectors;
+    }
+    if (geometry.clusters <= FAT16MAXCLUSTERS) {
+      geometry.firstDataSector = RESERVEDSECTORS+FATCOUNT*geometry.fatSectors+rootSectors;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void setFatEntry(std::vector<unsigned char> &fat, int fatType, unsigned long cluster, unsigned long value)
+{
+  if (fatType == 16) {
+    setLE(&fat[cluster*2], value, 2);
+    return;
+  }
+  size_t position = cluster*3/2;
+  if (cluster & 1) {
+    fat[position] = (fat[position] & 0x0f) | ((value << 4) & 0xf0);
+    fat[position+1] = (value >> 4) & 0xff;
+  } else {
+    fat[position] = value & 0xff;
+    fat[position+1] = (fat[position+1] & 0xf0) | ((value >> 8) & 0x0f);
+  }
+}
+
+// Get directory index for a path like "/ZH" and create missing directories
+static int getDirectory(std::vector<CONTENTDIRECTORY> &directories, const std::string &path)
+{
+  for (size_t i=0;i<directories.size();i++) if (directories[i].path == path) return i;
+  size_t slash = path.rfind('/');
+  CONTENTDIRECTORY directory;
+  directory.path = path;
+  directory.parent = getDirectory(directories, (slash == 0) ? "" : path.substr(0, slash));
+  if (!getShortName(path.substr(slash+1), directory.shortName, true)) fail("invalid directory name %s", path.c_str());
+  directory.firstCluster = 0;
+  directory.clusters = 0;
+  directories.push_back(directory);
+  return directories.size()-1;
+}
+
+static void readManifest(const char *manifest, std::vector<CONTENTFILE> &files, std::vector<CONTENTDIRECTORY> &directories)
+{
+  FILE *file = fopen(manifest, "r");
+  if (file == NULL) fail("%s: cannot open manifest", manifest);
+  std::string base(manifest);
+  size_t slash = base.rfind('/');
+  base = (slash == std::string::npos) ? "" : base.substr(0, slash+1);
+
+  CONTENTDIRECTORY root;
+  root.parent = -1;
+  root.firstCluster = 0;
+  root.clusters = 0;
+  directories.push_back(root);
+
+  std::vector<std::string> closedPaths;
+  std::string lastPath;
+  char line[1024];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char *comment = strchr(line, '#');
+    if (comment != NULL) *comment = '\0';
+    char source[1024], target[1024], constant[1024];
+    int fields = sscanf(line, "%1023s %1023s %1023s", source, target, constant);
+    if (fields <= 0) continue;
+    if (fields < 2) fail("manifest line without path on the drive: %s", source);
+
+    CONTENTFILE content;
+    content.source = source;
+    content.target = target;
+    if (content.target[0] != '/') fail("path on the drive must start with /: %s", target);
+    slash = content.target.rfind('/');
+    std::string path = content.target.substr(0, slash);
+    std::string name = content.target.substr(slash+1);
+    if (!getShortName(name, content.shortName, false)) fail("no 8+3 file name: %s", target);
+    std::string extension = content.shortName.substr(8);
+    if ((extension != "WAV") && (extension != "MP3")) fail("only WAV and MP3 files are supported: %s", target);
+    for (size_t i=0;i<files.size();i++) if (files[i].target == content.target) fail("duplicate file %s", target);
+
+    /* Directories, which were left, are closed. A file in a closed directory
+     * would break the "file copy order"
+     */
+    if (path != lastPath) {
+      for (size_t i=0;i<closedPaths.size();i++) {
+        if ((path == closedPaths[i]) || (path.compare(0, closedPaths[i].size()+1, closedPaths[i]+"/") == 0)) fail("files of %s are not listed one after another", closedPaths[i].c_str());
+      }
+      std::string left = lastPath;
+      while (!left.empty() && (path.compare(0, left.size()+1, left+"/") != 0) && (path != left)) {
+        closedPaths.push_back(left);
+        left = left.substr(0, left.rfind('/'));
+      }
+      lastPath = path;
+    }
+    content.directory = getDirectory(directories, path);
+
+    if (fields >= 3) content.constant = constant;
+    else {
+      content.constant = "TRACK";
+      for (size_t i=0;i<content.target.size()-4;i++) if (isalnum((unsigned char)content.target[i])) content.constant += content.target[i];
+    }
+    for (size_t i=0;i<content.constant.size();i++) {
+      if (!isalnum((unsigned char)content.constant[i]) && (content.constant[i] != '_')) fail("invalid constant %s", content.constant.c_str());
+    }
+    for (size_t i=0;i<files.size();i++) if (files[i].constant == content.constant) fail("duplicate constant %s", content.constant.c_str());
+
+    if (!readFile((source[0] == '/') ? source : base+source, content.data)) fail("%s: cannot read file", source);
+    bool valid = (extension == "WAV") ? getWavDuration(content.data, content.durationMS) : getMp3Duration(content.data, content.durationMS);
+    if (!valid) fail("%s: unknown audio format", content.source.c_str());
+    files.push_back(content);
+  }
+  fclose(file);
+  if (files.empty()) fail("%s: no files", manifest);
+}
+
+static void writeHeader(const char *headerFile, const char *manifest, const char *imageFile, const std::vector<CONTENTFILE> &files)
+{
+  FILE *file = fopen(headerFile, "w");
+  if (file == NULL) fail("%s: cannot write header", headerFile);
+  const char *manifestName = strrchr(manifest, '/');
+  manifestName = (manifestName == NULL) ? manifest : manifestName+1;
+  const char *imageName = strrchr(imageFile, '/');
+  imageName = (imageName == NULL) ? imageFile : imageName+1;
+
+  fprintf(file, "/**\n");
+  fprintf(file, " * Generated by dfr0534content from %s for the image %s\n", manifestName, imageName);
+  fprintf(file, " * Do not edit, run dfr0534content again after changing the manifest\n");
+  fprintf(file, " *\n");
+  fprintf(file, " * For each file:\n");
+  fprintf(file, " * - <constant>: File number for DFR0534::playFileByNumber()\n");
+  fprintf(file, " * - <constant>MS: Duration in ms\n");
+  fprintf(file, " * - <constant>NAME: Path for DFR0534::playFileByName() in flash memory\n");
+  fprintf(file, " */\n");
+  fprintf(file, "#pragma once\n\n");
+  fprintf(file, "#include <Arduino.h>\n\n");
+  fprintf(file, "/** Number of files */\n");
+  fprintf(file, "constexpr word CONTENTFILECOUNT = %lu;\n", (unsigned long)files.size());
+  for (size_t i=0;i<files.size();i++) {
+    const CONTENTFILE &content = files[i];
+    // Device path like "/ZH      /01      WAV"
+    std::string name;
+    size_t start = 1;
+    for (;;) {
+      size_t slash = content.target.find('/', start);
+      if (slash == std::string::npos) break;
+      std::string directory = content.target.substr(start, slash-start);
+      name += "/"+directory+std::string(8-directory.size(), ' ');
+      start = slash+1;
+    }
+    name += "/"+content.shortName;
+    fprintf(file, "\n/** %s (%s) */\n", content.target.c_str(), content.source.c_str());
+    fprintf(file, "constexpr word %s = %lu;\n", content.constant.c_str(), (unsigned long)i+1);
+    fprintf(file, "constexpr unsigned long %sMS = %lu;\n", content.constant.c_str(), content.durationMS);
+    fprintf(file, "#define %sNAME F(\"%s\")\n", content.constant.c_str(), name.c_str());
+  }
+  fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned long sizeMiB = 8;
+  int argument = 1;
+  if ((argc == 6) && (strcmp(argv[1], "-s") == 0)) {
+    sizeMiB = strtoul(argv[2], NULL, 10);
+    argument = 3;
+  }
+  if ((argc-argument != 3) || (sizeMiB < 1) || (sizeMiB > 2048)) {
+    fprintf(stderr, "Usage: %s [-s sizeMiB] manifest.txt content.img content.h\n", argv[0]);
+    return 1;
+  }
+  const char *manifest = argv[argument];
+  const char *imageFile = argv[argument+1];
+  const char *headerFile = argv[argument+2];
+
+  std::vector<CONTENTFILE> files;
+  std::vector<CONTENTDIRECTORY> directories;
+  readManifest(manifest, files, directories);
+
+  char sizeText[16];
+  snprintf(sizeText, sizeof(sizeText), "%lu", sizeMiB);
+  GEOMETRY geometry;
+  if (!getGeometry(sizeMiB, geometry)) fail("no FAT geometry for %s MiB", sizeText);
+  unsigned long clusterSize = geometry.sectorsPerCluster*SECTORSIZE;
+
+  std::vector<int> entryCount(directories.size(), 0);
+  for (size_t i=1;i<directories.size();i++) entryCount[directories[i].parent]++;
+  for (size_t i=0;i<files.size();i++) entryCount[files[i].directory]++;
+  if (entryCount[0] > ROOTENTRIES) fail("too many files in the root directory of %s", manifest);
+
+  // Clusters for subdirectories first, then file data in manifest order
+  unsigned long nextCluster = 2;
+  for (size_t i=1;i<directories.size();i++) {
+    directories[i].clusters = ((entryCount[i]+2)*DIRENTRYSIZE+clusterSize-1)/clusterSize;
+    directories[i].firstCluster = nextCluster;
+    nextCluster += directories[i].clusters;
+  }
+  for (size_t i=0;i<files.size();i++) {
+    unsigned long clusters = (files[i].data.size()+clusterSize-1)/clusterSize;
+    files[i].firstCluster = (clusters == 0) ? 0 : nextCluster;
+    nextCluster += clusters;
+  }
+  if (nextCluster-2 > geometry.clusters) fail("content does not fit into %s MiB", sizeText);
+
+  // Directory contents: "." and "..", then subdirectories and files in the order of the manifest
+  for (size_t i=1;i<directories.size();i++) {
+    addEntry(directories[i].entries, ".          ", ATTRDIRECTORY, directories[i].firstCluster, 0);
+    addEntry(directories[i].entries, "..         ", ATTRDIRECTORY, directories[directories[i].parent].firstCluster, 0);
+  }
+  std::vector<bool> listed(directories.size(), false);
+  for (size_t i=0;i<files.size();i++) {
+    // Create parent directories at the first file inside
+    std::vector<int> chain;
+    for (int directory=files[i].directory;(directory > 0) && !listed[directory];directory=directories[directory].parent) chain.push_back(directory);
+    for (size_t j=chain.size();j>0;j--) {
+      CONTENTDIRECTORY &directory = directories[chain[j-1]];
+      addEntry(directories[directory.parent].entries, directory.shortName, ATTRDIRECTORY, directory.firstCluster, 0);
+      listed[chain[j-1]] = true;
+    }
+    addEntry(directories[files[i].directory].entries, files[i].shortName, ATTRARCHIVE, files[i].firstCluster, files[i].data.size());
+  }
+
+  // Image
+  std::vector<unsigned char> image(geometry.totalSectors*SECTORSIZE, 0);
+  unsigned char *boot = &image[0];
+  memcpy(boot, "\xeb\x3c\x90" "DFR0534 ", 11);
+  setLE(&boot[11], SECTORSIZE, 2);
+  boot[13] = geometry.sectorsPerCluster;
+  setLE(&boot[14], RESERVEDSECTORS, 2);
+  boot[16] = FATCOUNT;
+  setLE(&boot[17], ROOTENTRIES, 2);
+  if (geometry.totalSectors < 0x10000) setLE(&boot[19], geometry.totalSectors, 2);
+  else setLE(&boot[32], geometry.totalSectors, 4);
+  boot[21] = 0xf8;
+  setLE(&boot[22], geometry.fatSectors, 2);
+  setLE(&boot[24], 32, 2);
+  setLE(&boot[26], 64, 2);
+  boot[36] = 0x80;
+  boot[38] = 0x29;
+  setLE(&boot[39], 0x05340534, 4); // Fixed volume ID
+  memcpy(&boot[43], "DFR0534    ", 11);
+  memcpy(&boot[54], (geometry.fatType == 12) ? "FAT12   " : "FAT16   ", 8);
+  boot[510] = 0x55;
+  boot[511] = 0xaa;
+
+  std::vector<unsigned char> fat(geometry.fatSectors*SECTORSIZE, 0);
+  unsigned long endOfChain = (geometry.fatType == 12) ? 0xfff : 0xffff;
+  setFatEntry(fat, geometry.fatType, 0, endOfChain & ~0x07);
+  setFatEntry(fat, geometry.fatType, 1, endOfChain);
+
+  unsigned long rootStart = (RESERVEDSECTORS+FATCOUNT*geometry.fatSectors)*SECTORSIZE;
+  memcpy(&image[rootStart], &directories[0].entries[0], directories[0].entries.size());
+  for (size_t i=1;i<directories.size();i++) {
+    for (unsigned long j=0;j<directories[i].clusters;j++) {
+      unsigned long cluster = directories[i].firstCluster+j;
+      setFatEntry(fat, geometry.fatType, cluster, (j+1 == directories[i].clusters) ? endOfChain : cluster+1);
+    }
+    memcpy(&image[(geometry.firstDataSector+(directories[i].firstCluster-2)*geometry.sectorsPerCluster)*SECTORSIZE], &directories[i].entries[0], directories[i].entries.size());
+  }
+  for (size_t i=0;i<files.size();i++) {
+    if (files[i].data.empty()) continue;
+    unsigned long clusters = (files[i].data.size()+clusterSize-1)/clusterSize;
+    for (unsigned long j=0;j<clusters;j++) {
+      unsigned long cluster = files[i].firstCluster+j;
+      setFatEntry(fat, geometry.fatType, cluster, (j+1 == clusters) ? endOfChain : cluster+1);
+    }
+    memcpy(&image[(geometry.firstDataSector+(files[i].firstCluster-2)*geometry.sectorsPerCluster)*SECTORSIZE], &files[i].data[0], files[i].data.size());
+  }
+  for (int i=0;i<FATCOUNT;i++) memcpy(&image[(RESERVEDSECTORS+i*geometry.fatSectors)*SECTORSIZE], &fat[0], fat.size());
+
+  FILE *file = fopen(imageFile, "wb");
+  if ((file == NULL) || (fwrite(&image[0], 1, image.size(), file) != image.size())) fail("%s: cannot write image", imageFile);
+  fclose(file);
+  writeHeader(headerFile, manifest, imageFile, files);
+
+  printf("%s: FAT%d, %lu files, %lu of %lu clusters with %lu bytes used\n", imageFile, geometry.fatType,
+    (unsigned long)files.size(), nextCluster-2, geometry.clusters, clusterSize);
+  return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * Program: dfr0534fuzz
+ *
+ * Description:
+ * Linux command line tool to fuzz the reply parser of the DFR0534 class.
+ * Arbitrary bytes are fed through a fake Stream into every request (receiveFrame(),
+ * checkFrame() and getReplyLength() via getStatus(), getFileName(), getSnapshot(),
+ * pollRuntime() ...) and the buffers of the caller are checked for overflows
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Build:
+ *   g++ -O1 -g -fsanitize=address,undefined -Ihost -I../../src -o dfr0534fuzz dfr0534fuzz.cpp ../../src/DFR0534.cpp
+ *
+ * Usage:
+ *   dfr0534fuzz [-n iterations] [-r seed] seed.bin ...
+ *
+ *   dfr0534fuzz seeds/0x*
+ *
+ *   -n iterations  Number of mutated inputs (default 100000)
+ *   -r seed        Seed for the random generator (default 1)
+ *
+ * - Every seed file is replayed unchanged first. Then random mutations
+ *   (changed, inserted, removed and duplicated bytes, joined seeds, changed data
+ *   lengths and repaired checksums) are replayed
+ * - Buffers of the caller are surrounded by guard bytes. A changed guard byte
+ *   stops the tool with the input in hex and exit code 2
+ * - Overflows of internal buffers are found by the address sanitizer
+ * - The number of replayed frames per second is printed at the end
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file dfr0534fuzz.cpp
+ * @version 1.0.4
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "DFR0534.h"
+
+#define FUZZMAXINPUT 256
+#define FUZZGUARDLENGTH 16
+#define FUZZGUARD 0xA5
+#define FUZZNAMELENGTH 12
+
+typedef std::vector<unsigned char> INPUT;
+
+// Stream, which returns the bytes of an input and drops the sent bytes
+class FuzzStream : public Stream {
+  public:
+    FuzzStream(const INPUT &input) { m_ptrInput = &input; }
+    int available() { return (m_position < m_ptrInput->size()) ? 1 : 0; }
+    int peek() { return available() ? (*m_ptrInput)[m_position] : -1; }
+    int read() { return available() ? (*m_ptrInput)[m_position++] : -1; }
+    size_t write(uint8_t data) { (void) data; return 1; }
+    using Print::write;
+  private:
+    const INPUT *m_ptrInput;
+    size_t m_position = 0;
+};
+
+// Buffer of the caller with guard bytes before and after the data
+template <size_t SIZE> struct GUARDED {
+  unsigned char before[FUZZGUARDLENGTH];
+  unsigned char data[SIZE];
+  unsigned char after[FUZZGUARDLENGTH];
+  GUARDED() {
+    memset(before, FUZZGUARD, sizeof(before));
+    memset(data, FUZZGUARD, sizeof(data));
+    memset(after, FUZZGUARD, sizeof(after));
+  }
+  bool isIntact() {
+    for (size_t i=0;i<FUZZGUARDLENGTH;i++) {
+      if ((before[i] != FUZZGUARD) || (after[i] != FUZZGUARD)) return false;
+    }
+    return true;
+  }
+};
+
+static unsigned long g_frames = 0;
+
+static void fail(const char *path, const char *reason, const INPUT &input)
+{
+  fprintf(stderr, "%s: %s\ninput:", path, reason);
+  for (size_t i=0;i<input.size();i++) fprintf(stderr, " %02X", input[i]);
+  fprintf(stderr, "\n");
+  exit(2);
+}
+
+// Check a received file name
+static void checkName(const char *path, const char *name, const INPUT &input)
+{
+  if (memchr(name, '\0', FUZZNAMELENGTH) == NULL) fail(path, "file name without '\\0'", input);
+}
+
+// Feed an input into every request of the DFR0534 class
+static void replay(const INPUT &input)
+{
+  byte hour, minute, second;
+
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getStatus(); }
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getDrivesStates(); }
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getDrive(); }
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getTotalFiles(); }
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getFileNumber(); }
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getFirstFileNumberInCurrentDirectory(); }
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getTotalFilesInCurrentDirectory(); }
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getDuration(hour, minute, second); }
+  { FuzzStream stream(input); DFR0534 audio(stream); audio.getRuntime(hour, minute, second); }
+  {
+    FuzzStream stream(input);
+    DFR0534 audio(stream);
+    GUARDED<FUZZNAMELENGTH> name;
+    if (audio.getFileName((char *) name.data)) checkName("getFileName", (char *) name.data, input);
+    if (!name.isIntact()) fail("getFileName", "write outside of the name buffer", input);
+  }
+  {
+    FuzzStream stream(input);
+    DFR0534 audio(stream);
+    GUARDED<sizeof(DFR0534::DFR0534SNAPSHOT)> buffer;
+    DFR0534::DFR0534SNAPSHOT *snapshot = (DFR0534::DFR0534SNAPSHOT *) buffer.data;
+    audio.getSnapshot(*snapshot);
+    if ((snapshot->fresh & DFR0534::SNAPSHOTFILENAME) != 0) checkName("getSnapshot", snapshot->name, input);
+    if (!buffer.isIntact()) fail("getSnapshot", "write outside of the snapshot", input);
+  }
+  {
+    FuzzStream stream(input);
+    DFR0534 audio(stream);
+    audio.pollRuntime(hour, minute, second);
+  }
+  g_frames += 12;
+}
+
+// Change an input randomly
+static void mutate(INPUT &input, const std::vector<INPUT> &seeds)
+{
+  int count = 1+rand() % 4;
+  for (int i=0;i<count;i++) {
+    size_t position = input.empty() ? 0 : rand() % input.size();
+    switch (rand() % 7) {
+      case 0: // Change a byte
+        if (!input.empty()) input[position] = rand();
+        break;
+      case 1: // Flip a bit
+        if (!input.empty()) input[position] ^= 1 << (rand() % 8);
+        break;
+      case 2: // Insert a byte, often the starting code
+        input.insert(input.begin()+position, (rand() % 2) ? STARTINGCODE : rand());
+        break;
+      case 3: // Remove a byte
+        if (!input.empty()) input.erase(input.begin()+position);
+        break;
+      case 4: // Duplicate the rest of the input
+        input.insert(input.end(), input.begin()+position, input.end());
+        break;
+      case 5: // Join another seed
+        if (!seeds.empty()) {
+          const INPUT &seed = seeds[rand() % seeds.size()];
+          input.insert(input.begin()+position, seed.begin(), seed.end());
+        }
+        break;
+      case 6: // Change the data length of the first frame
+        if (input.size() >= 3) input[2] = rand() % 32;
+        break;
+    }
+  }
+  if (input.size() > FUZZMAXINPUT) input.resize(FUZZMAXINPUT);
+  // Repair the checksum of the first frame, otherwise most mutations are only invalid frames
+  if ((rand() % 2) && (input.size() >= 4) && (input[0] == STARTINGCODE) && ((size_t)input[2]+4 <= input.size())) {
+    unsigned char sum = 0;
+    for (size_t i=0;i<(size_t)input[2]+3;i++) sum += input[i];
+    input[input[2]+3] = sum;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned long iterations = 100000;
+  unsigned int seed = 1;
+  std::vector<INPUT> seeds;
+
+  for (int i=1;i<argc;i++) {
+    if ((strcmp(argv[i], "-n") == 0) && (i+1 < argc)) {
+      iterations = strtoul(argv[++i], NULL, 10);
+    } else if ((strcmp(argv[i], "-r") == 0) && (i+1 < argc)) {
+      seed = strtoul(argv[++i], NULL, 10);
+    } else if (argv[i][0] == '-') {
+      fprintf(stderr, "Usage: %s [-n iterations] [-r seed] seed.bin ...\n", argv[0]);
+      return 1;
+    } else {
+      FILE *file = fopen(argv[i], "rb");
+      if (file == NULL) {
+        perror(argv[i]);
+        return 1;
+      }
+      INPUT input;
+      int c;
+      while ((c = fgetc(file)) != EOF) input.push_back(c);
+      fclose(file);
+      seeds.push_back(input);
+    }
+  }
+  srand(seed);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i=0;i<seeds.size();i++) replay(seeds[i]);
+  for (unsigned long i=0;i<iterations;i++) {
+    INPUT input;
+    if (!seeds.empty()) input = seeds[rand() % seeds.size()];
+    mutate(input, seeds);
+    replay(input);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double seconds = (end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)/1e9;
+  printf("%lu inputs, %lu frames, %.1f s, %.0f frames/s\n", seeds.size()+iterations, g_frames, seconds, (seconds > 0) ? g_frames/seconds : 0);
+  return 0;
+}
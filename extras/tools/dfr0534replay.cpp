@@ -0,0 +1,190 @@
+/**
+ * Program: dfr0534replay
+ *
+ * Description:
+ * Linux command line test for DFR0534Trace and DFR0534TraceReplay. A session with
+ * a simulated audio module is recorded, dumped and replayed to a new DFR0534 object
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Build:
+ *   g++ -O2 -Ihost -I../../src -o dfr0534replay dfr0534replay.cpp ../../src/DFR0534.cpp ../../src/DFR0534Trace.cpp
+ *
+ * Usage:
+ *   dfr0534replay
+ *
+ * Checks:
+ * - Received bytes are not returned before the recorded time has elapsed
+ *   (step by step with a test clock set by DFR0534TraceReplay::setClock())
+ * - Short and long (>= 127ms) pauses between records
+ * - The replayed session returns the recorded results without mismatches
+ * - Sent bytes, which differ from the trace, are counted as mismatches
+ *
+ * Prints one line per check and returns 0, when all checks passed
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file dfr0534replay.cpp
+ * @version 1.0.4
+ */
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "DFR0534.h"
+#include "DFR0534Trace.h"
+
+static int g_failed = 0;
+static unsigned long g_testMS = 0;
+
+static unsigned long testClock()
+{
+  return g_testMS;
+}
+
+static void check(const char *name, bool ok)
+{
+  printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+  if (!ok) g_failed++;
+}
+
+// Simulated audio module, which answers the requests of the session
+class ModuleStream : public Stream {
+  public:
+    int available() { return (m_position < m_reply.size()) ? 1 : 0; }
+    int peek() { return available() ? m_reply[m_position] : -1; }
+    int read() { return available() ? m_reply[m_position++] : -1; }
+    size_t write(uint8_t data)
+    {
+      m_frame.push_back(data);
+      if ((m_frame.size() >= 3) && (m_frame.size() == (size_t)m_frame[2]+4)) {
+        answer(m_frame[1]);
+        m_frame.clear();
+      }
+      return 1;
+    }
+    using Print::write;
+  private:
+    void answer(byte command)
+    {
+      switch (command) {
+        case 0x01: reply(command, (const byte *) "\x01", 1); break; // Playing
+        case 0x0D: reply(command, (const byte *) "\x00\x03", 2); break; // File 3
+        case 0x1E: reply(command, (const byte *) "TEST   WAV", 10); break;
+        case 0x24: reply(command, (const byte *) "\x00\x03\x19", 3); break; // 00:03:25
+      }
+    }
+    void reply(byte command, const byte *data, byte length)
+    {
+      byte sum = STARTINGCODE+command+length;
+      m_reply.push_back(STARTINGCODE);
+      m_reply.push_back(command);
+      m_reply.push_back(length);
+      for (byte i=0;i<length;i++) {
+        m_reply.push_back(data[i]);
+        sum += data[i];
+      }
+      m_reply.push_back(sum);
+    }
+    std::vector<byte> m_frame;
+    std::vector<byte> m_reply;
+    size_t m_position = 0;
+};
+
+// Output for DFR0534Trace::dump()
+class BufferPrint : public Print {
+  public:
+    size_t write(uint8_t data) { bytes.push_back(data); return 1; }
+    using Print::write;
+    std::vector<byte> bytes;
+};
+
+// Results of a session
+struct SESSION {
+  byte status;
+  word fileNumber;
+  char name[12];
+  bool duration;
+  byte hour, minute, second;
+};
+
+static void runSession(DFR0534 &audio, SESSION &session, word track)
+{
+  audio.playFileByNumber(track);
+  session.status = audio.getStatus();
+  session.fileNumber = audio.getFileNumber();
+  audio.getFileName(session.name);
+  session.duration = audio.getDuration(session.hour, session.minute, session.second);
+}
+
+// Replay a hand written trace step by step with the test clock
+static void checkTiming()
+{
+  const byte trace[] = {
+    'D', 'F', 'R', 'T', DFR0534TRACEVERSION,
+    0x00, 0xAA, // TX 0xAA
+    0x80 | 40, 0x55, // RX 0x55 after 40ms
+    0x80 | 0x7F, 0x01, 0x2C, 0x66 // RX 0x66 after 300ms
+  };
+  g_testMS = 1000;
+  DFR0534TraceReplay replay(trace, sizeof(trace));
+  replay.setClock(testClock);
+
+  check("no received byte before the sent byte", replay.available() == 0);
+  replay.write(0xAA);
+  check("sent byte matches", replay.getMismatchCount() == 0);
+  g_testMS += 39;
+  check("received byte not due after 39ms", (replay.available() == 0) && (replay.read() == -1));
+  g_testMS += 1;
+  check("received byte due after 40ms", (replay.available() == 1) && (replay.peek() == 0x55) && (replay.read() == 0x55));
+  g_testMS += 299;
+  check("long pause not elapsed after 299ms", replay.available() == 0);
+  g_testMS += 1;
+  check("long pause elapsed after 300ms", replay.read() == 0x66);
+  check("trace finished", replay.isFinished());
+
+  replay.rewind();
+  replay.write(0xAB);
+  check("different sent byte is a mismatch", replay.getMismatchCount() == 1);
+}
+
+int main()
+{
+  checkTiming();
+
+  // Record a session
+  ModuleStream module;
+  byte buffer[512];
+  DFR0534Trace trace(module, buffer, sizeof(buffer));
+  DFR0534 audio(trace);
+  SESSION recorded;
+  runSession(audio, recorded, 3);
+  check("session recorded", (recorded.status == DFR0534::PLAYING) && (recorded.fileNumber == 3) &&
+    (strcmp(recorded.name, "TEST   WAV") == 0) && recorded.duration && (trace.getDroppedCount() == 0));
+
+  BufferPrint dumped;
+  trace.dump(dumped);
+  check("dump length", dumped.bytes.size() == (size_t)trace.getLength()+5);
+
+  // Replay the session with the host clock
+  DFR0534TraceReplay replay(dumped.bytes.data(), dumped.bytes.size());
+  DFR0534 replayedAudio(replay);
+  SESSION replayed;
+  runSession(replayedAudio, replayed, 3);
+  check("replayed results match", (replayed.status == recorded.status) && (replayed.fileNumber == recorded.fileNumber) &&
+    (strcmp(replayed.name, recorded.name) == 0) && replayed.duration && (replayed.hour == recorded.hour) &&
+    (replayed.minute == recorded.minute) && (replayed.second == recorded.second));
+  check("replay without mismatches", replay.getMismatchCount() == 0);
+  check("replay finished", replay.isFinished());
+
+  // Replay with another file number
+  replay.rewind();
+  runSession(replayedAudio, replayed, 4);
+  check("changed request is a mismatch", replay.getMismatchCount() > 0);
+
+  printf("%s\n", (g_failed == 0) ? "all checks passed" : "checks failed");
+  return (g_failed == 0) ? 0 : 1;
+}
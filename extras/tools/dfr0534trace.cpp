@@ -0,0 +1,193 @@
+/**
+ * Program: dfr0534trace
+ *
+ * Description:
+ * Linux command line tool to decode a trace recorded by DFR0534Trace::dump()
+ * into frames with opcodes and payloads
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Build:
+ *   g++ -O2 -o dfr0534trace dfr0534trace.cpp
+ *
+ * Usage:
+ *   dfr0534trace trace.bin
+ *
+ * Output (one line per frame):
+ *   <ms since first record> <TX|RX> <bytes> <opcode name> <payload> <checksum state>
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file dfr0534trace.cpp
+ * @version 1.0.4
+ */
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define STARTINGCODE 0xAA
+#define TRACEVERSION 1
+#define TRACEDIRECTIONBIT 0x80
+#define TRACEDELTAMASK 0x7F
+#define TRACELONGDELTA 0x7F
+
+// Opcode names as used by the DFR0534 class
+static const char *opcodeName(unsigned char opcode)
+{
+  switch (opcode) {
+    case 0x01: return "getStatus";
+    case 0x02: return "play";
+    case 0x03: return "pause";
+    case 0x04: return "stop";
+    case 0x05: return "playPrevious";
+    case 0x06: return "playNext";
+    case 0x07: return "playFileByNumber";
+    case 0x08: return "playFileByName";
+    case 0x09: return "getDrivesStates";
+    case 0x0A: return "getDrive";
+    case 0x0B: return "setDrive";
+    case 0x0C: return "getTotalFiles";
+    case 0x0D: return "getFileNumber";
+    case 0x0E: return "playLastInDirectory";
+    case 0x0F: return "playNextDirectory";
+    case 0x10: return "stopInsertedFile";
+    case 0x11: return "getFirstFileNumberInCurrentDirectory";
+    case 0x12: return "getTotalFilesInCurrentDirectory";
+    case 0x13: return "setVolume";
+    case 0x14: return "increaseVolume";
+    case 0x15: return "decreaseVolume";
+    case 0x16: return "insertFileByNumber";
+    case 0x17: return "setDirectory";
+    case 0x18: return "setLoopMode";
+    case 0x19: return "setRepeatLoops";
+    case 0x1A: return "setEqualizer";
+    case 0x1B: return "playCombined";
+    case 0x1C: return "stopCombined";
+    case 0x1D: return "setChannel";
+    case 0x1E: return "getFileName";
+    case 0x1F: return "prepareFileByNumber";
+    case 0x20: return "repeatPart";
+    case 0x21: return "stopRepeatPart";
+    case 0x22: return "fastBackwardDuration";
+    case 0x23: return "fastForwardDuration";
+    case 0x24: return "getDuration";
+    case 0x25: return "startSendingRuntime/runtime";
+    case 0x26: return "stopSendingRuntime";
+    default: return "unknown";
+  }
+}
+
+// Bytes of one direction, which are collected until a frame is complete
+struct FRAME {
+  std::vector<unsigned char> bytes;
+  unsigned long startMS;
+};
+
+static void printBytes(const std::vector<unsigned char> &bytes)
+{
+  for (size_t i=0;i<bytes.size();i++) printf("%s%02X", (i>0) ? " " : "", bytes[i]);
+}
+
+static void printFrame(const char *direction, FRAME &frame)
+{
+  std::vector<unsigned char> &bytes = frame.bytes;
+  printf("%10lu %s ", frame.startMS, direction);
+  printBytes(bytes);
+  if ((bytes.size() < 4) || (bytes[0] != STARTINGCODE) || (bytes.size() != (size_t)bytes[2]+4)) {
+    printf("  <no frame>\n");
+    return;
+  }
+  unsigned char sum = 0;
+  for (size_t i=0;i+1<bytes.size();i++) sum += bytes[i];
+  printf("  %s", opcodeName(bytes[1]));
+  if (bytes[2] > 0) {
+    printf(" [");
+    bool text = (bytes[1] == 0x08) || (bytes[1] == 0x17) || (bytes[1] == 0x1B) || (bytes[1] == 0x1E);
+    for (size_t i=3;i<bytes.size()-1;i++) {
+      if (text && (bytes[i] >= 0x20) && (bytes[i] < 0x7F)) printf("%c", bytes[i]);
+      else printf("%s%u", ((i > 3) && !text) ? " " : "", bytes[i]);
+    }
+    printf("]");
+  }
+  printf("%s\n", (sum == bytes.back()) ? "" : "  <checksum error>");
+}
+
+// Add byte to a frame and print the frame, when it is complete
+static void addByte(const char *direction, FRAME &frame, unsigned char data, unsigned long nowMS)
+{
+  if (frame.bytes.empty()) {
+    frame.startMS = nowMS;
+    if (data != STARTINGCODE) {
+      // Byte outside of a frame
+      std::vector<unsigned char> single(1, data);
+      FRAME garbage = { single, nowMS };
+      printFrame(direction, garbage);
+      return;
+    }
+  }
+  frame.bytes.push_back(data);
+  if ((frame.bytes.size() >= 3) && (frame.bytes.size() == (size_t)frame.bytes[2]+4)) {
+    printFrame(direction, frame);
+    frame.bytes.clear();
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s trace.bin\n", argv[0]);
+    return 1;
+  }
+  FILE *file = fopen(argv[1], "rb");
+  if (file == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+  std::vector<unsigned char> trace;
+  int c;
+  while ((c = fgetc(file)) != EOF) trace.push_back(c);
+  fclose(file);
+
+  if ((trace.size() < 5) || (memcmp(&trace[0], "DFRT", 4) != 0)) {
+    fprintf(stderr, "%s: no DFR0534 trace\n", argv[1]);
+    return 1;
+  }
+  if (trace[4] != TRACEVERSION) {
+    fprintf(stderr, "%s: unsupported trace version %u\n", argv[1], trace[4]);
+    return 1;
+  }
+
+  FRAME tx, rx;
+  unsigned long nowMS = 0;
+  size_t position = 5;
+  bool first = true;
+  while (position+2 <= trace.size()) {
+    unsigned char header = trace[position];
+    unsigned long deltaMS;
+    unsigned char data;
+    if ((header & TRACEDELTAMASK) == TRACELONGDELTA) {
+      if (position+4 > trace.size()) break;
+      deltaMS = ((unsigned long)trace[position+1] << 8) | trace[position+2];
+      data = trace[position+3];
+      position += 4;
+    } else {
+      deltaMS = header & TRACEDELTAMASK;
+      data = trace[position+1];
+      position += 2;
+    }
+    // First record has a delta to a dropped record
+    if (!first) nowMS += deltaMS;
+    first = false;
+    if (header & TRACEDIRECTIONBIT) addByte("RX", rx, data, nowMS);
+    else addByte("TX", tx, data, nowMS);
+  }
+  // Incomplete frames at the end of the trace
+  if (!tx.bytes.empty()) printFrame("TX", tx);
+  if (!rx.bytes.empty()) printFrame("RX", rx);
+  if (position != trace.size()) fprintf(stderr, "%s: truncated record at end of trace\n", argv[1]);
+  return 0;
+}
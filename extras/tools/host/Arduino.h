@@ -0,0 +1,76 @@
+/**
+ * Description:
+ * Minimal Arduino API for compiling the library on Linux with the host tools
+ * like dfr0534fuzz. Only the parts used by the library are provided.
+ *
+ * millis() runs on a host clock, which is controlled by the tool: Every call
+ * returns hostMS and advances it by hostStepMS (default 1), so request timeouts
+ * end without waiting. delay() advances hostMS.
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file Arduino.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef uint16_t word;
+
+#define PROGMEM
+#define PGM_P const char *
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define strlen_P strlen
+#define memcpy_P memcpy
+class __FlashStringHelper;
+#define F(string) (reinterpret_cast<const __FlashStringHelper *>(string))
+
+// Host clock in ms
+inline unsigned long hostMS = 0;
+// Advance of the host clock per millis() call in ms
+inline unsigned long hostStepMS = 1;
+
+inline unsigned long millis()
+{
+  unsigned long nowMS = hostMS;
+  hostMS += hostStepMS;
+  return nowMS;
+}
+
+inline void delay(unsigned long ms)
+{
+  hostMS += ms;
+}
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t data) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+      size_t count = 0;
+      while (size-- > 0) count += write(*buffer++);
+      return count;
+    }
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int peek() = 0;
+    virtual int read() = 0;
+    using Print::write;
+};
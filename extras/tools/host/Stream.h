@@ -0,0 +1,18 @@
+/**
+ * Description:
+ * Stream class of the minimal Arduino API for the host tools (see Arduino.h)
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file Stream.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include "Arduino.h"
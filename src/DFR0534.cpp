@@ -42,69 +42,230 @@
  */
 #include "DFR0534.h"
 
+#define RECEIVEBYTETIMEOUTMS 100
+#define RECEIVEGLOBALTIMEOUTMS 500
+#define RECEIVEHEADERLENGTH 3 // startingcode+command+length
+// Maximum data length of a reply. Longer frames are treated as invalid
+#define RECEIVEMAXDATALENGTH 24
+// Maximum bytes read for one reply
+#define RECEIVEMAXBYTES 128
+// Results of checkFrame()
+#define FRAMEINCOMPLETE 0
+#define FRAMEINVALID 1
+#define FRAMECOMPLETE 2
+// Filter for receiveFrame() to accept every known reply
+#define RECEIVEANYCOMMAND 0x00
+// Maximum path length for playFileByName() and setDirectory() (frame length is path length + 1)
+#define MAXPATHLENGTH 254
+// Maximum list length for playCombined()
+#define MAXCOMBINEDLENGTH 254
+// Buffer size for getFileName() (8+3 chars plus '\0')
+#define FILENAMELENGTH 12
+// Runtimes received within this time after a command were sent before the command was processed
+#define SEEKSETTLEMS 50
+// Maximum wait time for a runtime (runtimes are sent every second)
+#define SEEKRUNTIMETIMEOUTMS 1500
+// Allowed difference in seconds between the target and the runtime after seekTo()
+#define SEEKTOLERANCESECONDS 1
+
 /**@brief
- * Get module status
+ * Send a request without data
  *
- * @retval DFR0534::STOPPED        Audio module is idle
- * @retval DFR0534::PLAYING        Audio module is playing a file
- * @retval DFR0534::PAUSED         Audio module is paused
- * @retval DFR0534::STATUSUNKNOWN  Error (for example request timeout)
+ * @param[in] command  Command of the request
  */
-byte DFR0534::getStatus()
+void DFR0534::sendRequest(byte command)
 {
-  #define COMMAND 0x01
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEFAILED STATUSUNKNOWN
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
-  if (m_ptrStream == NULL) return RECEIVEFAILED; // Should not happen
   sendStartingCode();
-  sendDataByte(COMMAND);;
-  sendDataByte(0x00);;
+  sendDataByte(command);
+  sendDataByte(0x00);
   sendCheckSum();
+}
 
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff, result = 0;
+/**@brief
+ * Get valid data length range for a reply
+ *
+ * @param[in]  command    Command of the reply
+ * @param[out] minLength  Minimum valid data length
+ * @param[out] maxLength  Maximum valid data length
+ *
+ * @retval true  Command is a known reply
+ * @retval false Unknown command
+ */
+bool DFR0534::getReplyLength(byte command, byte &minLength, byte &maxLength)
+{
+  switch (command) {
+    case 0x01: // getStatus
+    case 0x09: // getDrivesStates
+    case 0x0A: // getDrive
+      minLength = maxLength = 1;
+      return true;
+    case 0x0C: // getTotalFiles
+    case 0x0D: // getFileNumber
+    case 0x11: // getFirstFileNumberInCurrentDirectory
+    case 0x12: // getTotalFilesInCurrentDirectory
+      minLength = maxLength = 2;
+      return true;
+    case 0x1E: // getFileName
+      minLength = 0;
+      maxLength = RECEIVEMAXDATALENGTH;
+      return true;
+    case 0x24: // getDuration
+    case 0x25: // Runtime
+      minLength = maxLength = 3;
+      return true;
+  }
+  return false;
+}
+
+/**@brief
+ * Check received bytes for a valid reply frame
+ *
+ * @param[in] frame    Received bytes
+ * @param[in] count    Number of received bytes
+ * @param[in] command  Expected command or RECEIVEANYCOMMAND for every known reply
+ *
+ * @retval FRAMEINCOMPLETE  Bytes are a valid beginning of a frame
+ * @retval FRAMEINVALID     Bytes are no valid frame (wrong starting code, command, length or checksum)
+ * @retval FRAMECOMPLETE    Bytes are a complete and valid frame
+ */
+byte DFR0534::checkFrame(byte *frame, byte count, byte command)
+{
+  byte minLength, maxLength;
+  if (frame[0] != STARTINGCODE) return FRAMEINVALID;
+  if (count < 2) return FRAMEINCOMPLETE;
+  if ((command != RECEIVEANYCOMMAND) && (frame[1] != command)) return FRAMEINVALID;
+  if (!getReplyLength(frame[1], minLength, maxLength)) return FRAMEINVALID;
+  if (count < 3) return FRAMEINCOMPLETE;
+  if ((frame[2] < minLength) || (frame[2] > maxLength)) return FRAMEINVALID;
+  if (count < RECEIVEHEADERLENGTH+frame[2]+1) return FRAMEINCOMPLETE;
+
+  byte sum = 0;
+  for (byte i=0;i<count-1;i++) sum += frame[i];
+  return (frame[count-1] == sum) ? FRAMECOMPLETE : FRAMEINVALID; // Does checksum matches?
+}
+
+/**@brief
+ * Receive the reply for a request
+ *
+ * @param[in]  command  Expected command
+ * @param[out] data     Buffer for the data bytes
+ * @param[in]  size     Size of the buffer
+ *
+ * @returns Data length of the received frame (can be larger than the buffer size)
+ * @retval -1  Error (request timeout or too many invalid bytes)
+ */
+int DFR0534::receive(byte command, byte *data, byte size)
+{
+  return receiveFrame(command, command, data, size);
+}
+
+/**@brief
+ * Receive a reply frame
+ *
+ * Waits for a frame with the starting code, the expected command and a valid data length.
+ * The received bytes are kept in a small window.
+ * When the bytes in the window become an invalid frame (wrong command, length or checksum),
+ * the window is rescanned from the next starting code on. So a corrupted or unexpected byte
+ * only costs the bytes up to the next starting code and not the whole reply.
+ * The number of bytes read is limited to RECEIVEMAXBYTES, so the work per reply is
+ * bounded even for an endless stream of invalid bytes.
+ *
+ * @param[in]  filter   Expected command or RECEIVEANYCOMMAND for every known reply
+ * @param[out] command  Command of the received frame
+ * @param[out] data     Buffer for the data bytes
+ * @param[in]  size     Size of the buffer
+ *
+ * @returns Data length of the received frame (can be larger than the buffer size)
+ * @retval -1  Error (request timeout or too many invalid bytes)
+ */
+int DFR0534::receiveFrame(byte filter, byte &command, byte *data, byte size)
+{
+  byte frame[RECEIVEHEADERLENGTH+RECEIVEMAXDATALENGTH+1];
+  byte count = 0;
+  word received = 0;
+  if (m_ptrStream == NULL) return -1; // Should not happen
   unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
+  while (true) {
     unsigned long lastMS = millis();
     // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
+    while (m_ptrStream->available() == 0) {
+      if (millis()-lastMS >= RECEIVEBYTETIMEOUTMS) return -1; // Timeout
     }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 1) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
+    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return -1; // Timeout
+    if (++received > RECEIVEMAXBYTES) return -1; // Too many invalid bytes
+    frame[count++] = m_ptrStream->read();
+
+    while (count > 0) {
+      byte state = checkFrame(frame, count, filter);
+      if (state == FRAMEINCOMPLETE) break;
+      if (state == FRAMECOMPLETE) {
+        byte length = frame[2];
+        command = frame[1];
+        for (byte i=0;(i<length) && (i<size);i++) data[i] = frame[RECEIVEHEADERLENGTH+i];
+        return length;
       }
+      // Invalid frame => rescan from next starting code
+      byte next = 1;
+      while ((next < count) && (frame[next] != STARTINGCODE)) next++;
+      for (byte i=next;i<count;i++) frame[i-next] = frame[i];
+      count -= next;
     }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      result = data;
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
+  }
+}
+
+/**@brief
+ * Seek relative to the current position
+ *
+ * @param[in] seconds  Seconds to go forward (> 0) or backward (< 0)
+ *
+ * @retval true  Seek was sent or no seek needed
+ * @retval false Seek is too far
+ */
+bool DFR0534::seekBy(long seconds)
+{
+  if ((seconds > 0xffff) || (seconds < -0xffffL)) return false;
+  if (seconds > 0) fastForwardDuration(seconds);
+  if (seconds < 0) fastBackwardDuration(-seconds);
+  return true;
+}
+
+/**@brief
+ * Wait for the next runtime, which was sent after the last command
+ *
+ * @param[out] position  Runtime in seconds
+ *
+ * @retval true  Runtime received
+ * @retval false Timeout
+ */
+bool DFR0534::waitRuntime(unsigned long &position)
+{
+  byte hour, minute, second;
+  unsigned long startMS = millis();
+  // Drop runtimes sent before the last command was processed
+  while (millis()-startMS < SEEKSETTLEMS) pollRuntime(hour, minute, second);
+  while (millis()-startMS < SEEKRUNTIMETIMEOUTMS) {
+    if (pollRuntime(hour, minute, second)) {
+      position = hour*3600UL+minute*60UL+second;
+      return true;
     }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
+  }
+  return false;
+}
 
-  if (data != sum) return RECEIVEFAILED; // Does checksum matches?
+/**@brief
+ * Get module status
+ *
+ * @retval DFR0534::STOPPED        Audio module is idle
+ * @retval DFR0534::PLAYING        Audio module is playing a file
+ * @retval DFR0534::PAUSED         Audio module is paused
+ * @retval DFR0534::STATUSUNKNOWN  Error (for example request timeout)
+ */
+byte DFR0534::getStatus()
+{
+  byte result;
+  if (m_ptrStream == NULL) return STATUSUNKNOWN; // Should not happen
+  sendRequest(0x01);
+  if (receive(0x01, &result, 1) < 0) return STATUSUNKNOWN;
   return result;
 }
 
@@ -122,6 +283,7 @@ void DFR0534::setEqualizer(byte mode)
   sendDataByte(0x01);
   sendDataByte(mode);
   sendCheckSum();
+  m_equalizer = mode;
 }
 
 /**@brief
@@ -148,6 +310,7 @@ void DFR0534::playFileByNumber(word track)
  * Set volume
  *
  * Volumen levels 0-30 are allowed. Audio module starts always with level 20.
+ * The level is stored locally and can be read with getVolume().
  *
  * @param[in] volume  Volume level
  */
@@ -160,6 +323,7 @@ void DFR0534::setVolume(byte volume)
   sendDataByte(0x01);
   sendDataByte(volume);
   sendCheckSum();
+  m_volume = volume;
 }
 
 /**@brief
@@ -248,19 +412,44 @@ void DFR0534::playNext()
  * @param[in] path   Full path of the audio file
  * @param[in] drive  Drive, where file is stored: Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH (=default)
  */
-void DFR0534::playFileByName(char *path, byte drive)
+void DFR0534::playFileByName(const char *path, byte drive)
 {
-  if (m_ptrStream == NULL) return; // Should not happen
   if (path == NULL) return;
-  if (drive >= DRIVEUNKNOWN) return;
-  sendStartingCode();
-  sendDataByte(0x08);
-  sendDataByte(strlen(path)+1);
-  sendDataByte(drive);
-  for (int i=0;i<strlen(path);i++) {
-    sendDataByte(path[i]);
-  }
-  sendCheckSum();
+  size_t length = strlen(path);
+  if (length > MAXPATHLENGTH) return;
+  sendPathCommand(0x08, path, length, false, drive);
+}
+
+/**@brief
+ * Play audio file by file name/path with known length
+ *
+ * Like playFileByName(const char *path, byte drive), but without strlen().
+ * The path does not need a terminating '\0'.
+ *
+ * @param[in] path    Full path of the audio file
+ * @param[in] length  Number of chars in path (max. 254)
+ * @param[in] drive   Drive, where file is stored: Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH
+ */
+void DFR0534::playFileByName(const char *path, byte length, byte drive)
+{
+  sendPathCommand(0x08, path, length, false, drive);
+}
+
+/**@brief
+ * Play audio file by file name/path stored in flash memory
+ *
+ * Like playFileByName(const char *path, byte drive), but the path is read
+ * directly from flash memory, for example playFileByName(F("/01      WAV"))
+ *
+ * @param[in] path   Full path of the audio file in flash memory
+ * @param[in] drive  Drive, where file is stored: Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH (=default)
+ */
+void DFR0534::playFileByName(const __FlashStringHelper *path, byte drive)
+{
+  if (path == NULL) return;
+  size_t length = strlen_P((PGM_P) path);
+  if (length > MAXPATHLENGTH) return;
+  sendPathCommand(0x08, (PGM_P) path, length, true, drive);
 }
 
 /**@brief
@@ -276,59 +465,10 @@ void DFR0534::playFileByName(char *path, byte drive)
  */
 byte DFR0534::getDrivesStates()
 {
-  #define COMMAND 0x09
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEFAILED DRIVEUNKNOWN
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
-  if (m_ptrStream == NULL) return RECEIVEFAILED; // Should not happen
-  sendStartingCode();
-  sendDataByte(COMMAND);
-  sendDataByte(0x00);
-  sendCheckSum();
-
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff, result = 0;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 1) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
-      }
-    }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      result = data;
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
-
-  if (data != sum) return RECEIVEFAILED; // Does checksum matches?
+  byte result;
+  if (m_ptrStream == NULL) return DRIVEUNKNOWN; // Should not happen
+  sendRequest(0x09);
+  if (receive(0x09, &result, 1) < 0) return DRIVEUNKNOWN;
   return result;
 }
 
@@ -343,59 +483,11 @@ byte DFR0534::getDrivesStates()
  */
 byte DFR0534::getDrive()
 {
-  #define COMMAND 0x0A
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEFAILED DRIVEUNKNOWN
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
-  if (m_ptrStream == NULL) return RECEIVEFAILED; // Should not happen
-  sendStartingCode();
-  sendDataByte(COMMAND);
-  sendDataByte(0x00);
-  sendCheckSum();
-
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff, result = 0;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 1) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
-      }
-    }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      result = data;
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
-
-  if (data != sum) return RECEIVEFAILED; // Does checksum matches?
+  byte result;
+  if (m_ptrStream == NULL) return DRIVEUNKNOWN; // Should not happen
+  sendRequest(0x0A);
+  if (receive(0x0A, &result, 1) < 0) return DRIVEUNKNOWN;
+  if (result < DRIVEUNKNOWN) m_drive = result;
   return result;
 }
 
@@ -413,6 +505,7 @@ void DFR0534::setDrive(byte drive)
   sendDataByte(0x01);
   sendDataByte(drive);
   sendCheckSum();
+  m_drive = drive;
 }
 
 /**@brief
@@ -425,68 +518,11 @@ void DFR0534::setDrive(byte drive)
  */
 word DFR0534::getFileNumber()
 {
-  #define COMMAND 0x0D
-  #define RECEIVEFAILED 0
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
-  if (m_ptrStream == NULL) return RECEIVEFAILED; // Should not happen
-  sendStartingCode();
-  sendDataByte(COMMAND);
-  sendDataByte(0x00);
-  sendCheckSum();
-
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff;
-  word result = 0;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 2) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
-      }
-    }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      switch (i-RECEIVEHEADERLENGTH-1) {
-        case 0:
-          result=data<<8;
-          break;
-        case 1:
-          result+=data;
-          break;
-      }
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
-
-  if (data != sum) return RECEIVEFAILED; // Does checksum matches?
-  return result;
+  byte result[2];
+  if (m_ptrStream == NULL) return 0; // Should not happen
+  sendRequest(0x0D);
+  if (receive(0x0D, result, 2) < 0) return 0;
+  return ((word)result[0] << 8) | result[1];
 }
 
 /**@brief
@@ -497,68 +533,11 @@ word DFR0534::getFileNumber()
  */
 int DFR0534::getTotalFiles()
 {
-  #define COMMAND 0x0C
-  #define RECEIVEFAILED -1
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
-  if (m_ptrStream == NULL) return RECEIVEFAILED; // Should not happen
-  sendStartingCode();
-  sendDataByte(COMMAND);
-  sendDataByte(0x00);
-  sendCheckSum();
-
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff;
-  word result = 0;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 2) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
-      }
-    }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      switch (i-RECEIVEHEADERLENGTH-1) {
-        case 0:
-          result=data<<8;
-          break;
-        case 1:
-          result+=data;
-          break;
-      }
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
-
-  if (data != sum) return RECEIVEFAILED; // Does checksum matches?
-  return result;
+  byte result[2];
+  if (m_ptrStream == NULL) return -1; // Should not happen
+  sendRequest(0x0C);
+  if (receive(0x0C, result, 2) < 0) return -1;
+  return ((word)result[0] << 8) | result[1];
 }
 
 /**@brief
@@ -593,68 +572,11 @@ void DFR0534::playNextDirectory()
  */
 int DFR0534::getFirstFileNumberInCurrentDirectory()
 {
-  #define COMMAND 0x11
-  #define RECEIVEFAILED -1
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
-  if (m_ptrStream == NULL) RECEIVEFAILED; // Should not happen
-  sendStartingCode();
-  sendDataByte(COMMAND);
-  sendDataByte(0x00);
-  sendCheckSum();
-
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff;
-  word result = 0;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 2) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
-      }
-    }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      switch (i-RECEIVEHEADERLENGTH-1) {
-        case 0:
-          result=data<<8;
-          break;
-        case 1:
-          result+=data;
-          break;
-      }
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
-
-  if (data != sum) return RECEIVEFAILED; // Does checksum matches?
-  return result;
+  byte result[2];
+  if (m_ptrStream == NULL) return -1; // Should not happen
+  sendRequest(0x11);
+  if (receive(0x11, result, 2) < 0) return -1;
+  return ((word)result[0] << 8) | result[1];
 }
 
 /**@brief
@@ -665,72 +587,17 @@ int DFR0534::getFirstFileNumberInCurrentDirectory()
  */
 int DFR0534::getTotalFilesInCurrentDirectory()
 {
-  #define COMMAND 0x12
-  #define RECEIVEFAILED -1
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
-  if (m_ptrStream == NULL) RECEIVEFAILED; // Should not happen
-  sendStartingCode();
-  sendDataByte(COMMAND);
-  sendDataByte(0x00);
-  sendCheckSum();
-
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff;
-  word result = 0;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 2) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
-      }
-    }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      switch (i-RECEIVEHEADERLENGTH-1) {
-        case 0:
-          result=data<<8;
-          break;
-        case 1:
-          result+=data;
-          break;
-      }
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
-
-  if (data != sum) return RECEIVEFAILED; // Does checksum matches?
-  return result;
+  byte result[2];
+  if (m_ptrStream == NULL) return -1; // Should not happen
+  sendRequest(0x12);
+  if (receive(0x12, result, 2) < 0) return -1;
+  return ((word)result[0] << 8) | result[1];
 }
 
 /**@brief
  * Increase volume by one step
+ *
+ * The locally stored level for getVolume() is increased up to 30
  */
 void DFR0534::increaseVolume()
 {
@@ -739,10 +606,13 @@ void DFR0534::increaseVolume()
   sendDataByte(0x14);
   sendDataByte(0x00);
   sendCheckSum();
+  if (m_volume < 30) m_volume++;
 }
 
 /**@brief
  * Decrease volume by one step
+ *
+ * The locally stored level for getVolume() is decreased down to 0
  */
 void DFR0534::decreaseVolume()
 {
@@ -751,6 +621,7 @@ void DFR0534::decreaseVolume()
   sendDataByte(0x15);
   sendDataByte(0x00);
   sendCheckSum();
+  if (m_volume > 0) m_volume--;
 }
 
 /**@brief
@@ -794,19 +665,76 @@ void DFR0534::stopInsertedFile()
  * @param[in] path   Directory
  * @param[in] drive  Drive, where directory is stored: Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH (=default)
  */
-void DFR0534::setDirectory(char *path, byte drive)
+void DFR0534::setDirectory(const char *path, byte drive)
+{
+  if (path == NULL) return;
+  size_t length = strlen(path);
+  if (length > MAXPATHLENGTH) return;
+  sendPathCommand(0x17, path, length, false, drive);
+}
+
+/**@brief
+ * Should set directory with known path length, but does not work for me
+ *
+ * @param[in] path    Directory (without terminating '\0')
+ * @param[in] length  Number of chars in path (max. 254)
+ * @param[in] drive   Drive, where directory is stored: Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH
+ */
+void DFR0534::setDirectory(const char *path, byte length, byte drive)
+{
+  sendPathCommand(0x17, path, length, false, drive);
+}
+
+/**@brief
+ * Should set directory stored in flash memory, but does not work for me
+ *
+ * @param[in] path   Directory in flash memory
+ * @param[in] drive  Drive, where directory is stored: Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH (=default)
+ */
+void DFR0534::setDirectory(const __FlashStringHelper *path, byte drive)
+{
+  if (path == NULL) return;
+  size_t length = strlen_P((PGM_P) path);
+  if (length > MAXPATHLENGTH) return;
+  sendPathCommand(0x17, (PGM_P) path, length, true, drive);
+}
+
+/**@brief
+ * Send command with drive and path (used by playFileByName() and setDirectory())
+ *
+ * @param[in] command  Command
+ * @param[in] path     Path in RAM or flash memory
+ * @param[in] length   Number of chars in path (max. 254)
+ * @param[in] flash    true = path is in flash memory, false = path is in RAM
+ * @param[in] drive    Drive: DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH
+ */
+void DFR0534::sendPathCommand(byte command, const char *path, byte length, bool flash, byte drive)
 {
   if (m_ptrStream == NULL) return; // Should not happen
   if (path == NULL) return;
+  if (length > MAXPATHLENGTH) return;
   if (drive >= DRIVEUNKNOWN) return;
   sendStartingCode();
-  sendDataByte(0x17);
-  sendDataByte(strlen(path)+1);
+  sendDataByte(command);
+  sendDataByte(length+1);
   sendDataByte(drive);
-  for (int i=0;i<strlen(path);i++) {
-    sendDataByte(path[i]);
-  }
+  sendString(path, length, flash);
   sendCheckSum();
+  m_drive = drive;
+}
+
+/**@brief
+ * Send chars from RAM or flash memory as data bytes
+ *
+ * @param[in] string  Chars in RAM or flash memory
+ * @param[in] length  Number of chars
+ * @param[in] flash   true = string is in flash memory, false = string is in RAM
+ */
+void DFR0534::sendString(const char *string, byte length, bool flash)
+{
+  for (byte i=0;i<length;i++) {
+    sendDataByte(flash ? pgm_read_byte(string+i) : string[i]);
+  }
 }
 
 /**@brief
@@ -823,6 +751,7 @@ void DFR0534::setLoopMode(byte mode)
   sendDataByte(0x01);
   sendDataByte(mode);
   sendCheckSum();
+  m_loopMode = mode;
 }
 
 /**@brief
@@ -841,6 +770,7 @@ void DFR0534::setRepeatLoops(word loops)
   sendDataByte((loops >> 8) & 0xff);
   sendDataByte(loops & 0xff);
   sendCheckSum();
+  m_repeatLoops = loops;
 }
 
 /**@brief
@@ -854,18 +784,61 @@ void DFR0534::setRepeatLoops(word loops)
  *
  * @param[in] list  Concatenated list of all files to play
  */
-void DFR0534::playCombined(char* list)
+void DFR0534::playCombined(const char *list)
+{
+  if (list == NULL) return;
+  size_t length = strlen(list);
+  if (length > MAXCOMBINEDLENGTH) return;
+  sendCombined(list, length, false);
+}
+
+/**@brief
+ * Combined/concatenated play of files with known list length
+ *
+ * Like playCombined(const char *list), but without strlen().
+ * The list does not need a terminating '\0'.
+ *
+ * @param[in] list    Concatenated list of all files to play
+ * @param[in] length  Number of chars in list (must be even)
+ */
+void DFR0534::playCombined(const char *list, byte length)
+{
+  sendCombined(list, length, false);
+}
+
+/**@brief
+ * Combined/concatenated play of files with a list stored in flash memory
+ *
+ * Like playCombined(const char *list), but the list is read directly
+ * from flash memory, for example playCombined(F("0103"))
+ *
+ * @param[in] list  Concatenated list of all files to play in flash memory
+ */
+void DFR0534::playCombined(const __FlashStringHelper *list)
+{
+  if (list == NULL) return;
+  size_t length = strlen_P((PGM_P) list);
+  if (length > MAXCOMBINEDLENGTH) return;
+  sendCombined((PGM_P) list, length, true);
+}
+
+/**@brief
+ * Send combined play command
+ *
+ * @param[in] list    Concatenated list in RAM or flash memory
+ * @param[in] length  Number of chars in list (must be even)
+ * @param[in] flash   true = list is in flash memory, false = list is in RAM
+ */
+void DFR0534::sendCombined(const char *list, byte length, bool flash)
 {
   if (m_ptrStream == NULL) return; // Should not happen
   if (list == NULL) return;
-  if ((strlen(list) % 2) != 0) return;
+  if ((length % 2) != 0) return;
 
   sendStartingCode();
   sendDataByte(0x1B);
-  sendDataByte(strlen(list));
-  for (int i=0;i<strlen(list);i++) {
-    sendDataByte(list[i]);
-  }
+  sendDataByte(length);
+  sendString(list, length, flash);
   sendCheckSum();
 }
 
@@ -898,6 +871,7 @@ void DFR0534::setChannel(byte channel)
   sendDataByte(0x01);
   sendDataByte(channel);
   sendCheckSum();
+  m_channel = channel;
 }
 
 /**@brief
@@ -907,60 +881,25 @@ void DFR0534::setChannel(byte channel)
  * without the dot "." between name and extension,
  * e.g. "TEST   WAV" for the file test.wav
  *
+ * Replies with more than 24 chars are treated as invalid. Names longer than 11 chars are truncated.
+ *
  * @param[out] name  Filename. You have to allocate at least 12 chars memory for this variable.
  */
 bool DFR0534::getFileName(char *name)
 {
-  #define COMMAND 0x1E
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEFAILED false
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
   if (m_ptrStream == NULL) return false; // Should not happen
   if (name == NULL) return false;
   name[0] = '\0';
 
-  sendStartingCode();
-  sendDataByte(COMMAND);
-  sendDataByte(0x00);
-  sendCheckSum();
-
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) length = data; // Length of receiving string
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      if ((i-RECEIVEHEADERLENGTH) < 12) { // I expect no longer file names than 8+3 chars plus '\0'
-        name[i-RECEIVEHEADERLENGTH-1] = data;
-        name[i-RECEIVEHEADERLENGTH] = '\0';
-      }
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
-  return (data == sum); // Does checksum matches?
+  sendRequest(0x1E);
+  // I expect no longer file names than 8+3 chars plus '\0'
+  int length = receive(0x1E, (byte *) name, FILENAMELENGTH-1);
+  if (length < 0) {
+    name[0] = '\0';
+    return false;
+  }
+  name[(length < FILENAMELENGTH-1) ? length : FILENAMELENGTH-1] = '\0';
+  return true;
 }
 
 /**@brief
@@ -1062,70 +1001,14 @@ void DFR0534::fastForwardDuration(word seconds)
  */
 bool DFR0534::getDuration(byte &hour, byte &minute, byte &second)
 {
-  #define COMMAND 0x24
-  #define RECEIVEFAILED false
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
-
+  byte result[3];
   if (m_ptrStream == NULL) return false; // Should not happen
-  sendStartingCode();
-  sendDataByte(COMMAND);
-  sendDataByte(0x00);
-  sendCheckSum();
-
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff;
-  word result = 0;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
-
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
-
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 3) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
-      }
-    }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      switch (i-RECEIVEHEADERLENGTH-1) {
-        case 0:
-          hour=data;
-          break;
-        case 1:
-          minute=data;
-          break;
-        case 2:
-          second=data;
-          break;
-      }
-    }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
-
-  return (data == sum); // Does checksum matches?
+  sendRequest(0x24);
+  if (receive(0x24, result, 3) < 0) return false;
+  hour = result[0];
+  minute = result[1];
+  second = result[2];
+  return true;
 }
 
 /**@brief
@@ -1138,6 +1021,7 @@ void DFR0534::startSendingRuntime()
   sendDataByte(0x25);
   sendDataByte(0x00);
   sendCheckSum();
+  m_sendingRuntime = true;
 }
 
 /**@brief
@@ -1155,66 +1039,196 @@ void DFR0534::startSendingRuntime()
  */
 bool DFR0534::getRuntime(byte &hour, byte &minute, byte &second)
 {
-  #define COMMAND 0x25
-  #define RECEIVEFAILED false
-  #define RECEIVEBYTETIMEOUTMS 100
-  #define RECEIVEGLOBALTIMEOUTMS 500
-  #define RECEIVEHEADERLENGTH 2 // startingcode+command
+  byte result[3];
+  if (m_ptrStream == NULL) return false; // Should not happen
+  if (receive(0x25, result, 3) < 0) return false;
+  hour = result[0];
+  minute = result[1];
+  second = result[2];
+  m_lastRuntime = hour*3600UL+minute*60UL+second;
+  m_lastRuntimeMS = millis();
+  return true;
+}
 
+/**@brief
+ * Get elapsed runtime/duration of the current file without waiting
+ *
+ * Like getRuntime(), but only bytes already received are read and a partly received
+ * frame is kept for the next call. When several runtimes were received, the newest is returned.
+ * You have to call startSendingRuntime() before runtimes can be received.
+ * When several objects use the runtime, they should compare getLastRuntimeMS() instead
+ * of the return value, because a runtime is only returned to the first caller.
+ *
+ * @param[out] hour   Hours
+ * @param[out] minute Minutes
+ * @param[out] second Seconds
+ *
+ * @retval true  A new runtime was received
+ * @retval false No new runtime
+ */
+bool DFR0534::pollRuntime(byte &hour, byte &minute, byte &second)
+{
+  bool received = false;
   if (m_ptrStream == NULL) return false; // Should not happen
+  while (m_ptrStream->available() > 0) {
+    m_runtimeFrame[m_runtimeCount++] = m_ptrStream->read();
+    while (m_runtimeCount > 0) {
+      byte state = checkFrame(m_runtimeFrame, m_runtimeCount, 0x25);
+      if (state == FRAMEINCOMPLETE) break;
+      if (state == FRAMECOMPLETE) {
+        hour = m_runtimeFrame[RECEIVEHEADERLENGTH];
+        minute = m_runtimeFrame[RECEIVEHEADERLENGTH+1];
+        second = m_runtimeFrame[RECEIVEHEADERLENGTH+2];
+        m_lastRuntime = hour*3600UL+minute*60UL+second;
+        m_lastRuntimeMS = millis();
+        m_runtimeCount = 0;
+        received = true;
+        break;
+      }
+      // Invalid frame => rescan from next starting code
+      byte next = 1;
+      while ((next < m_runtimeCount) && (m_runtimeFrame[next] != STARTINGCODE)) next++;
+      for (byte i=next;i<m_runtimeCount;i++) m_runtimeFrame[i-next] = m_runtimeFrame[i];
+      m_runtimeCount -= next;
+    }
+  }
+  return received;
+}
 
-  // Receive
-  int i=0;
-  byte data, firstByte = 0, sum, length=0xff;
-  word result = 0;
-  unsigned long receiveStartMS = millis();
-  do {
-    byte dataReady = 0;
-    unsigned long lastMS = millis();
-    // Wait for response or timeout
-    while ((millis()-lastMS < RECEIVEBYTETIMEOUTMS) && (dataReady==0)) dataReady = m_ptrStream->available();
+/**@brief
+ * Seek to an absolute position in the current file
+ *
+ * The module only supports relative seeks in whole seconds. seekTo() reads the runtime,
+ * sends one fastForwardDuration() or fastBackwardDuration(), compares the runtime afterwards
+ * with the target and corrects once, when the difference is more than one second.
+ * Runtimes are enabled with startSendingRuntime() during the seek, when they were not enabled before.
+ * The file has to be playing, because the module sends no runtime otherwise.
+ * Needs about one second per runtime, so usually two or three seconds.
+ *
+ * @param[in] hour    Hours
+ * @param[in] minute  Minutes
+ * @param[in] second  Seconds
+ *
+ * @retval true  Runtime is at the target
+ * @retval false Runtime is not at the target or no runtime was received
+ */
+bool DFR0534::seekTo(byte hour, byte minute, byte second)
+{
+  DFR0534SEEKREPORT report;
+  return seekTo(hour, minute, second, report);
+}
 
-    if (dataReady == 0) return RECEIVEFAILED; // Timeout
-    data = m_ptrStream->read();
+/**@brief
+ * Seek to an absolute position in the current file and report the cost
+ *
+ * Like seekTo(hour, minute, second)
+ *
+ * @param[in]  hour    Hours
+ * @param[in]  minute  Minutes
+ * @param[in]  second  Seconds
+ * @param[out] report  Time, frames and corrections needed for the seek and the runtime afterwards
+ *
+ * @retval true  Runtime is at the target
+ * @retval false Runtime is not at the target or no runtime was received
+ */
+bool DFR0534::seekTo(byte hour, byte minute, byte second, DFR0534SEEKREPORT &report)
+{
+  unsigned long startMS = millis();
+  word startFrames = m_sentFrames;
+  unsigned long position = 0;
+  bool success = false;
+  report.corrections = 0;
+  report.hour = report.minute = report.second = 0;
+  if (m_ptrStream == NULL) return false; // Should not happen
 
-    if (i==0) { // Begin of transmission
-      firstByte=data;
-      sum = 0;
-    }
-    if ((i == 1) && (data != COMMAND)) {
-      // Invalid signal => reset receive
-      i=0;
-      firstByte = 0;
-    }
-    if (i == RECEIVEHEADERLENGTH) {
-      length = data; // Length of receiving data
-      if (length != 3) {
-        // Invalid length => reset receive
-        i=0;
-        firstByte = 0;
-      }
-    }
-    if ((i > RECEIVEHEADERLENGTH) && (i-RECEIVEHEADERLENGTH-1<length)) {
-      switch (i-RECEIVEHEADERLENGTH-1) {
-        case 0:
-          hour=data;
-          break;
-        case 1:
-          minute=data;
-          break;
-        case 2:
-          second=data;
-          break;
-      }
+  bool sendingRuntime = m_sendingRuntime;
+  if (!sendingRuntime) startSendingRuntime();
+  unsigned long target = hour*3600UL+minute*60UL+second;
+
+  if (waitRuntime(position)) {
+    // Runtime goes on during the seek => compare with the target plus the time since the seek
+    unsigned long seekMS = millis();
+    if (seekBy((long)target-(long)position) && waitRuntime(position)) {
+      long difference = (long)(target+(millis()-seekMS)/1000)-(long)position;
+      if ((difference > SEEKTOLERANCESECONDS) || (difference < -SEEKTOLERANCESECONDS)) {
+        report.corrections++;
+        if (seekBy(difference) && waitRuntime(position)) {
+          difference = (long)(target+(millis()-seekMS)/1000)-(long)position;
+          success = (difference <= SEEKTOLERANCESECONDS) && (difference >= -SEEKTOLERANCESECONDS);
+        }
+      } else success = true;
     }
-    if (firstByte == STARTINGCODE) {
-      if (i-RECEIVEHEADERLENGTH<=length) sum+=data; // Update checksum
-      i++;
-    }
-    if (millis()-receiveStartMS > RECEIVEGLOBALTIMEOUTMS) return RECEIVEFAILED; // Timeout
-  } while (i<length+RECEIVEHEADERLENGTH+2);
+    report.hour = position/3600;
+    report.minute = (position/60)%60;
+    report.second = position%60;
+  }
+
+  if (!sendingRuntime) stopSendingRuntime();
+  report.frames = m_sentFrames-startFrames;
+  report.elapsedMS = millis()-startMS;
+  return success;
+}
+
+/**@brief
+ * Get status, file number, file name, duration and drive with one burst of requests
+ *
+ * All five requests are sent at once and the replies are received in a single pass,
+ * instead of waiting for each reply before sending the next request.
+ * Fields without a valid reply keep their previous value and their bit in
+ * snapshot.fresh is cleared.
+ *
+ * @param[in,out] snapshot  Player state
+ *
+ * @retval true  All fields are fresh
+ * @retval false At least one request failed
+ */
+bool DFR0534::getSnapshot(DFR0534SNAPSHOT &snapshot)
+{
+  byte data[FILENAMELENGTH-1];
+  byte command;
+  unsigned long startMS = millis();
+  snapshot.fresh = 0;
+  if (m_ptrStream == NULL) return false; // Should not happen
 
-  return (data == sum); // Does checksum matches?
+  sendRequest(0x01);
+  sendRequest(0x0D);
+  sendRequest(0x1E);
+  sendRequest(0x24);
+  sendRequest(0x0A);
+
+  while (snapshot.fresh != SNAPSHOTALL) {
+    int length = receiveFrame(RECEIVEANYCOMMAND, command, data, sizeof(data));
+    if (length < 0) break; // Timeout
+    switch (command) {
+      case 0x01:
+        snapshot.status = data[0];
+        snapshot.fresh |= SNAPSHOTSTATUS;
+        break;
+      case 0x0D:
+        snapshot.fileNumber = ((word)data[0] << 8) | data[1];
+        snapshot.fresh |= SNAPSHOTFILENUMBER;
+        break;
+      case 0x1E:
+        if (length > FILENAMELENGTH-1) length = FILENAMELENGTH-1;
+        memcpy(snapshot.name, data, length);
+        snapshot.name[length] = '\0';
+        snapshot.fresh |= SNAPSHOTFILENAME;
+        break;
+      case 0x24:
+        snapshot.hour = data[0];
+        snapshot.minute = data[1];
+        snapshot.second = data[2];
+        snapshot.fresh |= SNAPSHOTDURATION;
+        break;
+      case 0x0A:
+        snapshot.drive = data[0];
+        if (data[0] < DRIVEUNKNOWN) m_drive = data[0];
+        snapshot.fresh |= SNAPSHOTDRIVE;
+        break;
+    }
+  }
+  snapshot.elapsedMS = millis()-startMS;
+  return (snapshot.fresh == SNAPSHOTALL);
 }
 
 /**@brief
@@ -1227,4 +1241,45 @@ void DFR0534::stopSendingRuntime()
   sendDataByte(0x26);
   sendDataByte(0x00);
   sendCheckSum();
+  m_sendingRuntime = false;
+}
+
+/**@brief
+ * Send all settings, which differ from the defaults after device startup
+ *
+ * Can be used to restore the settings after the audio module was switched off
+ * or restarted. Only settings with a value different from the device startup
+ * default are sent to keep the number of frames small.
+ *
+ * @returns Number of frames sent
+ */
+byte DFR0534::restoreSettings()
+{
+  if (m_ptrStream == NULL) return 0; // Should not happen
+  byte frames = 0;
+  if (m_drive < DRIVEUNKNOWN) {
+    setDrive(m_drive);
+    frames++;
+  }
+  if (m_volume != 20) {
+    setVolume(m_volume);
+    frames++;
+  }
+  if (m_equalizer != NORMAL) {
+    setEqualizer(m_equalizer);
+    frames++;
+  }
+  if (m_loopMode != SINGLEAUDIOSTOP) {
+    setLoopMode(m_loopMode);
+    frames++;
+  }
+  if (m_repeatLoops != 0) {
+    setRepeatLoops(m_repeatLoops);
+    frames++;
+  }
+  if (m_channel != CHANNELMP3) {
+    setChannel(m_channel);
+    frames++;
+  }
+  return frames;
 }
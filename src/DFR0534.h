@@ -79,6 +79,39 @@ class DFR0534 {
       PAUSED, /**< Audio module is paused */
       STATUSUNKNOWN /**< Unkown */
     };
+    /** Fields of a DFR0534SNAPSHOT */
+    enum DFR0534SNAPSHOTFIELDS
+    {
+      SNAPSHOTSTATUS = 1, /**< status */
+      SNAPSHOTFILENUMBER = 2, /**< fileNumber */
+      SNAPSHOTFILENAME = 4, /**< name */
+      SNAPSHOTDURATION = 8, /**< hour, minute and second */
+      SNAPSHOTDRIVE = 16, /**< drive */
+      SNAPSHOTALL = 31 /**< All fields */
+    };
+    /** Player state returned by getSnapshot() */
+    struct DFR0534SNAPSHOT
+    {
+      unsigned long elapsedMS; /**< Time needed for the snapshot in ms */
+      word fileNumber; /**< File number like getFileNumber() */
+      byte fresh; /**< Bit pattern of fields updated by the last snapshot (DFR0534::SNAPSHOTSTATUS...) */
+      byte status; /**< Status like getStatus() */
+      byte drive; /**< Drive like getDrive() */
+      byte hour; /**< Hours of the file duration */
+      byte minute; /**< Minutes of the file duration */
+      byte second; /**< Seconds of the file duration */
+      char name[12]; /**< File name like getFileName() */
+    };
+    /** Cost and result of seekTo() */
+    struct DFR0534SEEKREPORT
+    {
+      unsigned long elapsedMS; /**< Time needed for the seek in ms */
+      word frames; /**< Frames sent for the seek */
+      byte corrections; /**< Number of corrections after the first seek (0 or 1) */
+      byte hour; /**< Hours of the runtime after the seek */
+      byte minute; /**< Minutes of the runtime after the seek */
+      byte second; /**< Seconds of the runtime after the seek */
+    };
     /**@brief
      * Constructor of a the DFR0534 audio module
      *
@@ -91,31 +124,117 @@ class DFR0534 {
     void decreaseVolume();
     void fastBackwardDuration(word seconds);
     void fastForwardDuration(word seconds);
+    /**@brief
+     * Get last channel set by setChannel() without serial communication
+     *
+     * @returns Channel (DFR0534::CHANNELMP3 after device startup)
+     */
+    byte getChannel() { return m_channel; }
     byte getDrive();
     byte getDrivesStates();
     bool getDuration(byte &hour, byte &minute, byte &second);
+    /**@brief
+     * Get last EQ mode set by setEqualizer() without serial communication
+     *
+     * @returns EQ mode (DFR0534::NORMAL after device startup)
+     */
+    byte getEqualizer() { return m_equalizer; }
     bool getFileName(char *name);
     word getFileNumber();
     int getFirstFileNumberInCurrentDirectory();
+    /**@brief
+     * Get newest runtime received by getRuntime() or pollRuntime() without serial communication
+     *
+     * @returns Runtime in seconds
+     */
+    unsigned long getLastRuntime() { return m_lastRuntime; }
+    /**@brief
+     * Get time, when the newest runtime was received by getRuntime() or pollRuntime()
+     *
+     * Can be compared with a previous value to detect a new runtime
+     *
+     * @returns millis() timestamp (0 = no runtime received)
+     */
+    unsigned long getLastRuntimeMS() { return m_lastRuntimeMS; }
+    /**@brief
+     * Get time of the last frame sent to the audio module
+     *
+     * @returns millis() timestamp
+     */
+    unsigned long getLastSendMS() { return m_lastSendMS; }
+    /**@brief
+     * Get last loop mode set by setLoopMode() without serial communication
+     *
+     * @returns Loop mode (DFR0534::SINGLEAUDIOSTOP after device startup)
+     */
+    byte getLoopMode() { return m_loopMode; }
+    /**@brief
+     * Get last repeat loops set by setRepeatLoops() without serial communication
+     *
+     * @returns Number of loops (0 = never set)
+     */
+    word getRepeatLoops() { return m_repeatLoops; }
     bool getRuntime(byte &hour, byte &minute, byte &second);
+    /**@brief
+     * Get number of frames (commands and requests) sent to the audio module
+     *
+     * @returns Number of frames (overflows after 65535)
+     */
+    word getSentFrames() { return m_sentFrames; }
+    /**@brief
+     * Get number of bytes sent to the audio module
+     *
+     * @returns Number of bytes
+     */
+    unsigned long getSentBytes() { return m_sentBytes; }
+    /**@brief
+     * Get last drive selected by setDrive(), playFileByName(), setDirectory() or returned by getDrive() without serial communication
+     *
+     * @returns Drive (DFR0534::DRIVEUNKNOWN, when no drive was selected or requested)
+     */
+    byte getSelectedDrive() { return m_drive; }
+    bool getSnapshot(DFR0534SNAPSHOT &snapshot);
     byte getStatus();
     int getTotalFiles();
     int getTotalFilesInCurrentDirectory();
+    /**@brief
+     * Get volume level set by setVolume(), increaseVolume() or decreaseVolume() without serial communication
+     *
+     * @returns Volume level (0 = mute, 30 = max, 20 after device startup)
+     */
+    byte getVolume() { return m_volume; }
     void increaseVolume();
     void insertFileByNumber(word track, byte drive=DRIVEFLASH);
+    /**@brief
+     * Checks whether runtimes were enabled by startSendingRuntime() without serial communication
+     *
+     * @retval true  startSendingRuntime() was called last
+     * @retval false stopSendingRuntime() was called last or runtimes were never enabled
+     */
+    bool isSendingRuntime() { return m_sendingRuntime; }
     void pause();
     void play();
-    void playCombined(char* list);
-    void playFileByName(char *path, byte drive=DRIVEFLASH);
+    void playCombined(const char *list);
+    void playCombined(const char *list, byte length);
+    void playCombined(const __FlashStringHelper *list);
+    void playFileByName(const char *path, byte drive=DRIVEFLASH);
+    void playFileByName(const char *path, byte length, byte drive);
+    void playFileByName(const __FlashStringHelper *path, byte drive=DRIVEFLASH);
     void playFileByNumber(word track);
     void playLastInDirectory();
     void playNext();
     void playNextDirectory();
     void playPrevious();
+    bool pollRuntime(byte &hour, byte &minute, byte &second);
     void prepareFileByNumber(word track);
     void repeatPart(byte startMinute, byte startSecond, byte stopMinute, byte stopSecond );
+    byte restoreSettings();
+    bool seekTo(byte hour, byte minute, byte second);
+    bool seekTo(byte hour, byte minute, byte second, DFR0534SEEKREPORT &report);
     void setChannel(byte channel);
-    void setDirectory(char *path, byte drive=DRIVEFLASH);
+    void setDirectory(const char *path, byte drive=DRIVEFLASH);
+    void setDirectory(const char *path, byte length, byte drive);
+    void setDirectory(const __FlashStringHelper *path, byte drive=DRIVEFLASH);
     void setDrive(byte drive);
     void setEqualizer(byte mode);
     void setLoopMode(byte mode);
@@ -128,17 +247,48 @@ class DFR0534 {
     void stopRepeatPart();
     void stopSendingRuntime();
   private:
+    byte checkFrame(byte *frame, byte count, byte command);
+    bool getReplyLength(byte command, byte &minLength, byte &maxLength);
+    int receive(byte command, byte *data, byte size);
+    int receiveFrame(byte filter, byte &command, byte *data, byte size);
+    bool seekBy(long seconds);
+    void sendCombined(const char *list, byte length, bool flash);
+    void sendPathCommand(byte command, const char *path, byte length, bool flash, byte drive);
+    void sendRequest(byte command);
+    void sendString(const char *string, byte length, bool flash);
+    bool waitRuntime(unsigned long &position);
     void sendStartingCode() {
       m_checksum=STARTINGCODE;
       m_ptrStream->write((byte)STARTINGCODE);
+      m_lastSendMS = millis();
+      m_sentFrames++;
+      m_sentBytes++;
     }
     void sendDataByte(byte data) {
       m_checksum +=data;
       m_ptrStream->write((byte)data);
+      m_sentBytes++;
     }
     void sendCheckSum() {
       m_ptrStream->write((byte)m_checksum);
+      m_sentBytes++;
     }
     byte m_checksum;
+    // Shadow copy of the settings written to the audio module (initialized with the defaults after device startup)
+    byte m_volume = 20;
+    byte m_equalizer = NORMAL;
+    byte m_loopMode = SINGLEAUDIOSTOP;
+    word m_repeatLoops = 0;
+    byte m_channel = CHANNELMP3;
+    byte m_drive = DRIVEUNKNOWN;
+    bool m_sendingRuntime = false;
+    unsigned long m_lastSendMS = 0;
+    word m_sentFrames = 0;
+    unsigned long m_sentBytes = 0;
+    unsigned long m_lastRuntime = 0;
+    unsigned long m_lastRuntimeMS = 0;
+    // Partly received runtime frame for pollRuntime()
+    byte m_runtimeFrame[7];
+    byte m_runtimeCount = 0;
     Stream *m_ptrStream = NULL;
 };
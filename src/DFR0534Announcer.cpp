@@ -0,0 +1,245 @@
+/**
+ * Class: DFR0534Announcer
+ *
+ * Description:
+ * Priority scheduler for announcements played with DFR0534::insertFileByNumber()
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - An announcement with a higher priority than the running announcement
+ *   stops the running announcement with DFR0534::stopInsertedFile() and starts immediately
+ * - Announcements with the same or a lower priority wait in a FIFO queue
+ * - Waiting announcements with a maxWaitMS > 0 are dropped, when they waited too long
+ * - tick() has to be called frequently from loop(). tick() never waits for
+ *   an announcement to finish, it only sends status requests every ANNOUNCERPOLLMS
+ * - Limitation: The status requests use the blocking DFR0534::getStatus() and
+ *   DFR0534::getFileNumber(). While an announcement is running, a tick() every
+ *   ANNOUNCERPOLLMS blocks for the request and reply (about 10ms per request at 9600 baud,
+ *   up to the request timeout, when the module does not answer). Sketches with tight
+ *   timing can call tick() as poller of a DFR0534Scheduler
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Announcer.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Announcer.h"
+
+// Interval for checking whether the running announcement has finished
+#define ANNOUNCERPOLLMS 250
+// Time the audio module needs to start an inserted file
+#define ANNOUNCERSTARTUPMS 500
+
+/**@brief
+ * Add an announcement
+ *
+ * The announcement starts immediately, when no announcement is running or
+ * the running announcement has a lower priority. Otherwise it will be queued.
+ * When the queue is full, the oldest announcement with the lowest priority is
+ * dropped, if its priority is lower than the priority of the new announcement.
+ *
+ * @param[in] track      File number of the audio file
+ * @param[in] priority   Priority: DFR0534Announcer::PRIORITYINFO, DFR0534Announcer::PRIORITYCHIME or DFR0534Announcer::PRIORITYALARM
+ * @param[in] maxWaitMS  Maximum time in ms the announcement can wait in the queue (0 = wait forever)
+ * @param[in] drive      Drive, where file is stored: Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH (=default)
+ *
+ * @retval true  Announcement was started or queued
+ * @retval false Announcement was rejected (invalid parameter or queue full)
+ */
+bool DFR0534Announcer::announce(word track, byte priority, unsigned long maxWaitMS, byte drive)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if (track <= 0) return false;
+  if (priority >= PRIORITYUNKNOWN) return false;
+  if (drive >= DFR0534::DRIVEUNKNOWN) return false;
+
+  ANNOUNCEMENT announcement;
+  announcement.track = track;
+  announcement.priority = priority;
+  announcement.drive = drive;
+  announcement.queuedMS = millis();
+  announcement.maxWaitMS = maxWaitMS;
+
+  if (!m_active) {
+    start(announcement);
+    return true;
+  }
+  if (priority > m_current.priority) {
+    // Preempt running announcement
+    m_ptrAudio->stopInsertedFile();
+    m_preemptedCount++;
+    start(announcement);
+    return true;
+  }
+
+  if (m_queueCount >= DFR0534ANNOUNCERQUEUESIZE) {
+    // Queue is sorted by priority => last entry has the lowest priority
+    byte lowest = m_queue[m_queueCount-1].priority;
+    if (lowest >= priority) return false;
+    // Drop the first (oldest) entry with the lowest priority
+    byte oldest = m_queueCount-1;
+    while ((oldest > 0) && (m_queue[oldest-1].priority == lowest)) oldest--;
+    m_queueCount--;
+    for (byte i=oldest;i<m_queueCount;i++) m_queue[i] = m_queue[i+1];
+    m_expiredCount++;
+  }
+
+  // Insert behind all announcements with the same or a higher priority (FIFO per priority)
+  byte position = m_queueCount;
+  while ((position > 0) && (m_queue[position-1].priority < priority)) {
+    m_queue[position] = m_queue[position-1];
+    position--;
+  }
+  m_queue[position] = announcement;
+  m_queueCount++;
+  return true;
+}
+
+/**@brief
+ * Remove all waiting announcements
+ *
+ * A running announcement is not stopped
+ */
+void DFR0534Announcer::clear()
+{
+  m_queueCount = 0;
+}
+
+/**@brief
+ * Get number of waiting announcements
+ *
+ * @returns Number of waiting announcements
+ */
+byte DFR0534Announcer::getQueueCount()
+{
+  return m_queueCount;
+}
+
+/**@brief
+ * Get number of announcements, which were dropped without being played
+ *
+ * @returns Number of expired announcements
+ */
+word DFR0534Announcer::getExpiredCount()
+{
+  return m_expiredCount;
+}
+
+/**@brief
+ * Get queue wait time of the last started announcement
+ *
+ * @returns Wait time in ms
+ */
+unsigned long DFR0534Announcer::getLastWaitMS()
+{
+  return m_lastWaitMS;
+}
+
+/**@brief
+ * Get maximum queue wait time of all started announcements
+ *
+ * @returns Wait time in ms
+ */
+unsigned long DFR0534Announcer::getMaxWaitMS()
+{
+  return m_maxWaitMS;
+}
+
+/**@brief
+ * Get mean queue wait time of all started announcements
+ *
+ * @returns Wait time in ms
+ */
+unsigned long DFR0534Announcer::getMeanWaitMS()
+{
+  if (m_startedCount == 0) return 0;
+  return m_sumWaitMS/m_startedCount;
+}
+
+/**@brief
+ * Get number of announcements, which were stopped by an announcement with a higher priority
+ *
+ * @returns Number of preempted announcements
+ */
+word DFR0534Announcer::getPreemptedCount()
+{
+  return m_preemptedCount;
+}
+
+/**@brief
+ * Checks whether an announcement is running or waiting
+ *
+ * @retval true  Announcement is running or waiting
+ * @retval false Idle
+ */
+bool DFR0534Announcer::isBusy()
+{
+  return m_active || (m_queueCount > 0);
+}
+
+/**@brief
+ * Drop expired announcements and start the next announcement, when the running announcement has finished
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Announcer::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  unsigned long nowMS = millis();
+
+  // Drop stale announcements
+  byte count = 0;
+  for (byte i=0;i<m_queueCount;i++) {
+    if ((m_queue[i].maxWaitMS > 0) && (nowMS-m_queue[i].queuedMS > m_queue[i].maxWaitMS)) {
+      m_expiredCount++;
+    } else m_queue[count++] = m_queue[i];
+  }
+  m_queueCount = count;
+
+  if (m_active) {
+    if (nowMS-m_startMS < ANNOUNCERSTARTUPMS) return;
+    if (nowMS-m_lastPollMS < ANNOUNCERPOLLMS) return;
+    m_lastPollMS = nowMS;
+
+    /* The inserted file has finished, when the module is no longer playing
+     * or has resumed the original file
+     */
+    byte status = m_ptrAudio->getStatus();
+    if (status == DFR0534::STATUSUNKNOWN) return; // Try again later
+    if (status == DFR0534::PLAYING) {
+      word fileNumber = m_ptrAudio->getFileNumber();
+      if ((fileNumber == 0) || (fileNumber == m_current.track)) return;
+    }
+    m_active = false;
+  }
+
+  if (m_queueCount == 0) return;
+  ANNOUNCEMENT announcement = m_queue[0];
+  m_queueCount--;
+  for (byte i=0;i<m_queueCount;i++) m_queue[i] = m_queue[i+1];
+  start(announcement);
+}
+
+/**@brief
+ * Start announcement and update wait time statistics
+ *
+ * @param[in] announcement  Announcement to start
+ */
+void DFR0534Announcer::start(ANNOUNCEMENT &announcement)
+{
+  m_ptrAudio->insertFileByNumber(announcement.track, announcement.drive);
+  m_current = announcement;
+  m_active = true;
+  m_startMS = millis();
+  m_lastPollMS = m_startMS;
+
+  m_lastWaitMS = m_startMS-announcement.queuedMS;
+  if (m_lastWaitMS > m_maxWaitMS) m_maxWaitMS = m_lastWaitMS;
+  m_sumWaitMS += m_lastWaitMS;
+  m_startedCount++;
+}
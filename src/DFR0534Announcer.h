@@ -0,0 +1,80 @@
+/**
+ * Class: DFR0534Announcer
+ *
+ * Description:
+ * Priority scheduler for announcements played with DFR0534::insertFileByNumber()
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Announcer.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/** Maximum number of waiting announcements */
+#define DFR0534ANNOUNCERQUEUESIZE 8
+
+/**@brief
+ * Class for a priority queue of announcements on a DFR0534 audio module
+ */
+class DFR0534Announcer {
+  public:
+    /** Announcement priorities */
+    enum DFR0534PRIORITY
+    {
+      PRIORITYINFO, /**< Informational prompt */
+      PRIORITYCHIME, /**< Door chime or similar */
+      PRIORITYALARM, /**< Alarm (=highest priority) */
+      PRIORITYUNKNOWN /**< Unknown */
+    };
+    /**@brief
+     * Constructor of an announcement scheduler
+     *
+     * @param[in] audio  DFR0534 audio module used for the announcements
+     */
+    DFR0534Announcer(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+    }
+    bool announce(word track, byte priority, unsigned long maxWaitMS=0, byte drive=DFR0534::DRIVEFLASH);
+    void clear();
+    byte getQueueCount();
+    word getExpiredCount();
+    unsigned long getLastWaitMS();
+    unsigned long getMaxWaitMS();
+    unsigned long getMeanWaitMS();
+    word getPreemptedCount();
+    bool isBusy();
+    void tick();
+  private:
+    struct ANNOUNCEMENT {
+      word track;
+      byte priority;
+      byte drive;
+      unsigned long queuedMS;
+      unsigned long maxWaitMS;
+    };
+    void start(ANNOUNCEMENT &announcement);
+    ANNOUNCEMENT m_queue[DFR0534ANNOUNCERQUEUESIZE];
+    ANNOUNCEMENT m_current;
+    byte m_queueCount = 0;
+    bool m_active = false;
+    unsigned long m_startMS = 0;
+    unsigned long m_lastPollMS = 0;
+    unsigned long m_lastWaitMS = 0;
+    unsigned long m_maxWaitMS = 0;
+    unsigned long m_sumWaitMS = 0;
+    word m_startedCount = 0;
+    word m_expiredCount = 0;
+    word m_preemptedCount = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,362 @@
+/**
+ * Class: DFR0534Composer
+ *
+ * Description:
+ * Composer for numbers, decimal values and times of day as lists of two char
+ * files in the directory /ZH for DFR0534::playCombined()
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - The add functions append files to a fixed buffer of DFR0534COMPOSERBUFFERSIZE chars.
+ *   They allocate no memory and need at most a few dozen steps. When the files do not
+ *   fit into the buffer, nothing is appended and false is returned
+ * - Numbers from -999999 to 999999 are supported
+ * - play() sends the list in chunks of up to DFR0534COMPOSERCHUNKLENGTH chars.
+ *   tick() sends the next chunk, when the module has stopped playing the previous one
+ * - The table ENGLISH needs the files 00-19, 20, 30, ... 90, HU, TH, MI, PT, OC and OH in /ZH.
+ *   The example content (assets/exampleContent) has no 30-90 and no word clips, they
+ *   can be created with createContent.ps1
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Composer.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Composer.h"
+
+// Interval for checking whether the running chunk has finished
+#define COMPOSERPOLLMS 250
+// Time the audio module needs to start a combined play
+#define COMPOSERSTARTUPMS 500
+// Largest supported absolute value
+#define COMPOSERMAXNUMBER 999999L
+// Maximum digits after the decimal point
+#define COMPOSERMAXDECIMALS 6
+
+const DFR0534Composer::DFR0534LANGUAGE DFR0534Composer::ENGLISH PROGMEM = {
+  { {'0','0'}, {'0','1'}, {'0','2'}, {'0','3'}, {'0','4'}, {'0','5'}, {'0','6'}, {'0','7'}, {'0','8'}, {'0','9'},
+    {'1','0'}, {'1','1'}, {'1','2'}, {'1','3'}, {'1','4'}, {'1','5'}, {'1','6'}, {'1','7'}, {'1','8'}, {'1','9'} },
+  { {'2','0'}, {'3','0'}, {'4','0'}, {'5','0'}, {'6','0'}, {'7','0'}, {'8','0'}, {'9','0'} },
+  {'H','U'}, // hundred
+  {'T','H'}, // thousand
+  {'\0','\0'}, // conjunction
+  {'M','I'}, // minus
+  {'P','T'}, // point
+  {'\0','\0'}, // hour
+  {'O','C'}, // o'clock
+  {'O','H'}, // minuteZero
+  0 // flags
+};
+
+/**@brief
+ * Append a file
+ *
+ * @param[in] clip  Two char file name in /ZH, like "DG"
+ *
+ * @retval true  File appended
+ * @retval false Invalid file name or buffer full
+ */
+bool DFR0534Composer::addClip(const char *clip)
+{
+  if (clip == NULL) return false;
+  if ((clip[0] == '\0') || (clip[1] == '\0')) return false;
+  return append(clip[0], clip[1]);
+}
+
+/**@brief
+ * Append a decimal value
+ *
+ * The digits after the decimal point are spoken one by one,
+ * for example addDecimal(-215, 1) for "minus twenty one point five"
+ *
+ * @param[in] value     Value multiplied by 10^decimals
+ * @param[in] decimals  Digits after the decimal point (0-6)
+ *
+ * @retval true  Value appended
+ * @retval false Value out of range or buffer full
+ */
+bool DFR0534Composer::addDecimal(long value, byte decimals)
+{
+  if (decimals > COMPOSERMAXDECIMALS) return false;
+  byte length = m_length;
+
+  unsigned long divisor = 1;
+  for (byte i=0;i<decimals;i++) divisor *= 10;
+  unsigned long absolute = (value < 0) ? 0UL-(unsigned long)value : value;
+  if (absolute/divisor > COMPOSERMAXNUMBER) return false;
+
+  bool success = true;
+  if (value < 0) success = addRule(m_language->minus);
+  if (success) success = addNumber(absolute/divisor);
+  if (success && (decimals > 0)) {
+    success = addRule(m_language->point);
+    unsigned long fraction = absolute % divisor;
+    while (success && (divisor > 1)) {
+      divisor /= 10;
+      success = addUnit(fraction/divisor);
+      fraction %= divisor;
+    }
+  }
+  if (!success) {
+    m_length = length;
+    m_list[m_length] = '\0';
+  }
+  return success;
+}
+
+/**@brief
+ * Append an integer
+ *
+ * @param[in] value  Number (-999999 to 999999)
+ *
+ * @retval true  Number appended
+ * @retval false Number out of range or buffer full
+ */
+bool DFR0534Composer::addNumber(long value)
+{
+  if ((value > COMPOSERMAXNUMBER) || (value < -COMPOSERMAXNUMBER)) return false;
+  byte length = m_length;
+
+  bool success = true;
+  if (value < 0) {
+    success = addRule(m_language->minus);
+    value = -value;
+  }
+  if (success) {
+    if (value == 0) success = addUnit(0);
+    else {
+      word thousands = value/1000;
+      word rest = value%1000;
+      if (thousands > 0) {
+        if ((thousands > 1) || !(pgm_read_byte(&m_language->flags) & LANGUAGEIMPLICITONE)) success = addGroup(thousands);
+        if (success) success = addRule(m_language->thousand);
+      }
+      if (success && (rest > 0)) success = addGroup(rest);
+    }
+  }
+  if (!success) {
+    m_length = length;
+    m_list[m_length] = '\0';
+  }
+  return success;
+}
+
+/**@brief
+ * Append a time of day
+ *
+ * For example "seven o'clock" for 7:00 and "seven oh five" for 7:05
+ * with the English rule table
+ *
+ * @param[in] hour    Hour (0-23)
+ * @param[in] minute  Minute (0-59)
+ *
+ * @retval true  Time appended
+ * @retval false Invalid time or buffer full
+ */
+bool DFR0534Composer::addTime(byte hour, byte minute)
+{
+  if ((hour > 23) || (minute > 59)) return false;
+  byte length = m_length;
+
+  bool success = addNumber(hour) && addRule(m_language->hour);
+  if (success) {
+    if (minute == 0) success = addRule(m_language->oClock);
+    else {
+      if (minute < 10) success = addRule(m_language->minuteZero);
+      if (success) success = addNumber(minute);
+    }
+  }
+  if (!success) {
+    m_length = length;
+    m_list[m_length] = '\0';
+  }
+  return success;
+}
+
+/**@brief
+ * Remove all files from the list
+ *
+ * A running chunk is not stopped, but no further chunks are sent
+ */
+void DFR0534Composer::clear()
+{
+  m_length = 0;
+  m_list[0] = '\0';
+  m_position = 0;
+  m_active = false;
+}
+
+/**@brief
+ * Get number of chars in the list
+ *
+ * @returns Number of chars (two per file)
+ */
+byte DFR0534Composer::getLength()
+{
+  return m_length;
+}
+
+/**@brief
+ * Get composed list
+ *
+ * @returns List for DFR0534::playCombined()
+ */
+const char *DFR0534Composer::getList()
+{
+  return m_list;
+}
+
+/**@brief
+ * Checks whether chunks are left or the last chunk is running
+ *
+ * @retval true  Composed list is playing
+ * @retval false Idle
+ */
+bool DFR0534Composer::isBusy()
+{
+  return m_active;
+}
+
+/**@brief
+ * Start playing the composed list
+ *
+ * Only the first chunk is sent. tick() sends the remaining chunks.
+ *
+ * @retval true  Playback started
+ * @retval false List is empty
+ */
+bool DFR0534Composer::play()
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if (m_length == 0) return false;
+  m_position = 0;
+  m_active = true;
+  playChunk();
+  return true;
+}
+
+/**@brief
+ * Stop playing the composed list
+ */
+void DFR0534Composer::stop()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (!m_active) return;
+  m_ptrAudio->stopCombined();
+  m_active = false;
+}
+
+/**@brief
+ * Send the next chunk, when the running chunk has finished
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Composer::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (!m_active) return;
+  unsigned long nowMS = millis();
+  if (nowMS-m_chunkStartMS < COMPOSERSTARTUPMS) return;
+  if (nowMS-m_lastPollMS < COMPOSERPOLLMS) return;
+  m_lastPollMS = nowMS;
+
+  if (m_ptrAudio->getStatus() != DFR0534::STOPPED) return; // Still playing or try again later
+  if (m_position >= m_length) {
+    m_active = false;
+    return;
+  }
+  playChunk();
+}
+
+/**@brief
+ * Append a number from 1 to 999
+ *
+ * @param[in] value  Number
+ *
+ * @retval true  Number appended
+ * @retval false Buffer full
+ */
+bool DFR0534Composer::addGroup(word value)
+{
+  byte flags = pgm_read_byte(&m_language->flags);
+  byte hundreds = value/100;
+  byte rest = value%100;
+  if (hundreds > 0) {
+    if ((hundreds > 1) || !(flags & LANGUAGEIMPLICITONE)) {
+      if (!addUnit(hundreds)) return false;
+    }
+    if (!addRule(m_language->hundred)) return false;
+  }
+  if (rest == 0) return true;
+  if (rest < 20) return addUnit(rest);
+
+  const char *tens = m_language->tens[rest/10-2];
+  byte units = rest%10;
+  if (units == 0) return addRule(tens);
+  if (flags & LANGUAGEUNITSFIRST) return addUnit(units) && addRule(m_language->conjunction) && addRule(tens);
+  return addRule(tens) && addUnit(units);
+}
+
+/**@brief
+ * Append a file from the language rule table
+ *
+ * @param[in] clip  Two char file name in flash memory
+ *
+ * @retval true  File appended or nothing to append
+ * @retval false Buffer full
+ */
+bool DFR0534Composer::addRule(const char *clip)
+{
+  char high = pgm_read_byte(&clip[0]);
+  if (high == '\0') return true;
+  return append(high, pgm_read_byte(&clip[1]));
+}
+
+/**@brief
+ * Append the file for a number from 0 to 19
+ *
+ * @param[in] value  Number
+ *
+ * @retval true  File appended
+ * @retval false Buffer full
+ */
+bool DFR0534Composer::addUnit(byte value)
+{
+  return addRule(m_language->units[value]);
+}
+
+/**@brief
+ * Append two chars to the list
+ *
+ * @param[in] high  First char
+ * @param[in] low   Second char
+ *
+ * @retval true  Chars appended
+ * @retval false Buffer full
+ */
+bool DFR0534Composer::append(char high, char low)
+{
+  if (m_length+2 > DFR0534COMPOSERBUFFERSIZE) return false;
+  m_list[m_length++] = high;
+  m_list[m_length++] = low;
+  m_list[m_length] = '\0';
+  return true;
+}
+
+/**@brief
+ * Send the next chunk with DFR0534::playCombined()
+ */
+void DFR0534Composer::playChunk()
+{
+  byte length = m_length-m_position;
+  if (length > DFR0534COMPOSERCHUNKLENGTH) length = DFR0534COMPOSERCHUNKLENGTH;
+  m_ptrAudio->playCombined(&m_list[m_position], length);
+  m_position += length;
+  m_chunkStartMS = millis();
+  m_lastPollMS = m_chunkStartMS;
+}
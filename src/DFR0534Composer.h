@@ -0,0 +1,98 @@
+/**
+ * Class: DFR0534Composer
+ *
+ * Description:
+ * Composer for numbers, decimal values and times of day as lists of two char
+ * files in the directory /ZH for DFR0534::playCombined()
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Composer.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/** Maximum number of chars in the list (two chars per file) */
+#define DFR0534COMPOSERBUFFERSIZE 64
+/** Maximum number of chars sent with one DFR0534::playCombined() */
+#define DFR0534COMPOSERCHUNKLENGTH 32
+
+/**@brief
+ * Class for composing and playing spoken numbers on a DFR0534 audio module
+ */
+class DFR0534Composer {
+  public:
+    /** Language flags */
+    enum DFR0534LANGUAGEFLAGS
+    {
+      LANGUAGEUNITSFIRST = 1, /**< Units before tens, like "one and twenty" */
+      LANGUAGEIMPLICITONE = 2 /**< No "one" before hundred or thousand */
+    };
+    /**@brief
+     * Language rule table with two char file names (stored in flash memory with PROGMEM)
+     *
+     * A file name starting with '\0' is not played
+     */
+    struct DFR0534LANGUAGE
+    {
+      char units[20][2]; /**< Files for 0-19 */
+      char tens[8][2]; /**< Files for 20, 30, ... 90 */
+      char hundred[2]; /**< File for "hundred" */
+      char thousand[2]; /**< File for "thousand" */
+      char conjunction[2]; /**< File between units and tens, when LANGUAGEUNITSFIRST is set */
+      char minus[2]; /**< File for "minus" */
+      char point[2]; /**< File for the decimal point */
+      char hour[2]; /**< File after the hour of a time */
+      char oClock[2]; /**< File after the hour of a full hour */
+      char minuteZero[2]; /**< File before minutes 1-9 of a time, like "oh" */
+      byte flags; /**< Bit pattern of DFR0534LANGUAGEFLAGS */
+    };
+    /** English rule table: 00-19, 20, 30, ... 90, HU, TH, MI, PT, OC (o'clock) and OH */
+    static const DFR0534LANGUAGE ENGLISH;
+    /**@brief
+     * Constructor of a composer
+     *
+     * @param[in] audio     DFR0534 audio module
+     * @param[in] language  Language rule table in flash memory (=DFR0534Composer::ENGLISH by default)
+     */
+    DFR0534Composer(DFR0534 &audio, const DFR0534LANGUAGE *language=&ENGLISH)
+    {
+      m_ptrAudio = &audio;
+      m_language = language;
+      m_list[0] = '\0';
+    }
+    bool addClip(const char *clip);
+    bool addDecimal(long value, byte decimals);
+    bool addNumber(long value);
+    bool addTime(byte hour, byte minute);
+    void clear();
+    byte getLength();
+    const char *getList();
+    bool isBusy();
+    bool play();
+    void stop();
+    void tick();
+  private:
+    bool addGroup(word value);
+    bool addRule(const char *clip);
+    bool addUnit(byte value);
+    bool append(char high, char low);
+    void playChunk();
+    const DFR0534LANGUAGE *m_language = NULL;
+    char m_list[DFR0534COMPOSERBUFFERSIZE+1];
+    byte m_length = 0;
+    byte m_position = 0;
+    bool m_active = false;
+    unsigned long m_chunkStartMS = 0;
+    unsigned long m_lastPollMS = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
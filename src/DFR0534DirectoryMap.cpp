@@ -0,0 +1,277 @@
+/**
+ * Class: DFR0534DirectoryMap
+ *
+ * Description:
+ * Map of the visited directories on a DFR0534 audio module for browsing
+ * directories without repeated requests
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - Requirement on the drive content: The files of a directory must have consecutive
+ *   file numbers (in "file copy order"), so a directory is stored as first file number
+ *   and file count (4 bytes). The Linux tool extras/tools/dfr0534content checks this
+ *   for its manifest. learn() rejects a directory, whose range overlaps a known range
+ *   (files of the directory not consecutive or drive content changed without clear())
+ * - playNextDirectory() without a known next directory waits up to DIRECTORYMAPSWITCHMS
+ *   until DFR0534::getFirstFileNumberInCurrentDirectory() returns the new directory,
+ *   before it learns the directory. With only one directory the wait ends by timeout
+ * - learn() requests DFR0534::getFirstFileNumberInCurrentDirectory() and
+ *   DFR0534::getTotalFilesInCurrentDirectory() once for a directory. The ranges are
+ *   sorted by the first file number and findDirectory() uses a binary search
+ * - playNextDirectory(), playLastInDirectory() and playDirectory() use
+ *   DFR0534::playFileByNumber() for known directories and only fall back to the
+ *   directory commands of the audio module plus learn() for unknown directories
+ * - When the map is full, the range at the opposite end of the map is dropped
+ * - Call clear(), when the drive or its content has changed
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534DirectoryMap.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534DirectoryMap.h"
+
+// Maximum wait for the directory switch by DFR0534::playNextDirectory()
+#define DIRECTORYMAPSWITCHMS 500
+
+/**@brief
+ * Remove all directories
+ */
+void DFR0534DirectoryMap::clear()
+{
+  m_count = 0;
+  m_currentFirst = 0;
+}
+
+/**@brief
+ * Find directory, which contains a file, without serial communication
+ *
+ * @param[in] track  File number
+ *
+ * @returns Index of the directory in the map
+ * @retval -1  Directory not in the map
+ */
+int DFR0534DirectoryMap::findDirectory(word track)
+{
+  // Binary search for the last range starting at or before track
+  int low = 0;
+  int high = m_count-1;
+  int found = -1;
+  while (low <= high) {
+    int middle = (low+high)/2;
+    if (m_ranges[middle].first <= track) {
+      found = middle;
+      low = middle+1;
+    } else high = middle-1;
+  }
+  if (found < 0) return -1;
+  if (track-m_ranges[found].first >= m_ranges[found].count) return -1;
+  return found;
+}
+
+/**@brief
+ * Get number of directories in the map
+ *
+ * @returns Number of directories
+ */
+byte DFR0534DirectoryMap::getCount()
+{
+  return m_count;
+}
+
+/**@brief
+ * Get directory of the last played or learned file without serial communication
+ *
+ * @returns Index of the directory in the map
+ * @retval -1  Unknown
+ */
+int DFR0534DirectoryMap::getCurrent()
+{
+  if (m_currentFirst == 0) return -1;
+  return findDirectory(m_currentFirst);
+}
+
+/**@brief
+ * Get file range of a directory
+ *
+ * @param[in] index   Index of the directory in the map (sorted by file number)
+ * @param[out] first  First file number
+ * @param[out] count  Number of files
+ *
+ * @retval true  Directory found
+ * @retval false Invalid index
+ */
+bool DFR0534DirectoryMap::getDirectory(byte index, word &first, word &count)
+{
+  if (index >= m_count) return false;
+  first = m_ranges[index].first;
+  count = m_ranges[index].count;
+  return true;
+}
+
+/**@brief
+ * Get number of directory changes without requests
+ *
+ * @returns Number of directory changes
+ */
+word DFR0534DirectoryMap::getHitCount()
+{
+  return m_hitCount;
+}
+
+/**@brief
+ * Get number of requests sent by the map
+ *
+ * @returns Number of requests
+ */
+word DFR0534DirectoryMap::getQueryCount()
+{
+  return m_queryCount;
+}
+
+/**@brief
+ * Request file range of the current directory and add it to the map
+ *
+ * @returns Index of the directory in the map
+ * @retval -1  Request failed or empty directory
+ * @retval -2  Range overlaps a known directory (files of a directory not consecutive or drive content changed)
+ */
+int DFR0534DirectoryMap::learn()
+{
+  if (m_ptrAudio == NULL) return -1; // Should not happen
+  m_queryCount++;
+  int first = m_ptrAudio->getFirstFileNumberInCurrentDirectory();
+  if (first <= 0) return -1;
+  m_queryCount++;
+  int count = m_ptrAudio->getTotalFilesInCurrentDirectory();
+  if (count <= 0) return -1;
+
+  byte position = 0;
+  while ((position < m_count) && (m_ranges[position].first < first)) position++;
+  bool known = (position < m_count) && (m_ranges[position].first == first);
+  // Check the neighbours for overlaps
+  if ((position > 0) && ((long)m_ranges[position-1].first+m_ranges[position-1].count > first)) {
+    m_currentFirst = 0;
+    return -2;
+  }
+  byte next = known ? position+1 : position;
+  if ((next < m_count) && ((long)first+count > m_ranges[next].first)) {
+    m_currentFirst = 0;
+    return -2;
+  }
+  m_currentFirst = first;
+  if (known) {
+    m_ranges[position].count = count;
+    return position;
+  }
+
+  if (m_count >= DFR0534DIRECTORYMAPSIZE) {
+    // Map is full => Drop range at the opposite end
+    if (position > m_count/2) {
+      for (byte i=0;i<m_count-1;i++) m_ranges[i] = m_ranges[i+1];
+      position--;
+    }
+    m_count--;
+  }
+  for (byte i=m_count;i>position;i--) m_ranges[i] = m_ranges[i-1];
+  m_ranges[position].first = first;
+  m_ranges[position].count = count;
+  m_count++;
+  return position;
+}
+
+/**@brief
+ * Play first file of a known directory without requests
+ *
+ * @param[in] index  Index of the directory in the map
+ *
+ * @retval true  File started
+ * @retval false Invalid index
+ */
+bool DFR0534DirectoryMap::playDirectory(byte index)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if (index >= m_count) return false;
+  m_currentFirst = m_ranges[index].first;
+  m_ptrAudio->playFileByNumber(m_currentFirst);
+  return true;
+}
+
+/**@brief
+ * Play last file in the current directory
+ *
+ * Uses the map, when the current directory is known.
+ * Otherwise sends DFR0534::playLastInDirectory() and learns the directory.
+ *
+ * @retval true  Directory is in the map
+ * @retval false Directory could not be learned
+ */
+bool DFR0534DirectoryMap::playLastInDirectory()
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  int current = getCurrent();
+  if (current >= 0) {
+    m_ptrAudio->playFileByNumber(m_ranges[current].first+m_ranges[current].count-1);
+    m_hitCount++;
+    return true;
+  }
+  m_ptrAudio->playLastInDirectory();
+  return (learn() >= 0);
+}
+
+/**@brief
+ * Play first file in the next directory
+ *
+ * Uses the map, when the current and the next directory are known.
+ * Otherwise sends DFR0534::playNextDirectory() and learns the directory.
+ *
+ * @retval true  Directory is in the map
+ * @retval false Directory could not be learned
+ */
+bool DFR0534DirectoryMap::playNextDirectory()
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  int current = getCurrent();
+  if ((current >= 0) && (current+1 < m_count)) {
+    RANGE &next = m_ranges[current+1];
+    if (next.first == m_ranges[current].first+m_ranges[current].count) {
+      m_currentFirst = next.first;
+      m_ptrAudio->playFileByNumber(m_currentFirst);
+      m_hitCount++;
+      return true;
+    }
+  }
+  int previousFirst = m_currentFirst;
+  if (previousFirst == 0) {
+    m_queryCount++;
+    previousFirst = m_ptrAudio->getFirstFileNumberInCurrentDirectory();
+  }
+  m_ptrAudio->playNextDirectory();
+  if (waitForDirectory(previousFirst) <= 0) return false;
+  return (learn() >= 0);
+}
+
+/**@brief
+ * Wait until the audio module has switched to another directory
+ *
+ * @param[in] previousFirst  First file number of the directory before the switch
+ *
+ * @returns First file number of the current directory
+ * @retval -1  Request failed
+ */
+int DFR0534DirectoryMap::waitForDirectory(int previousFirst)
+{
+  unsigned long startMS = millis();
+  int first;
+  do {
+    m_queryCount++;
+    first = m_ptrAudio->getFirstFileNumberInCurrentDirectory();
+    if ((first > 0) && (first != previousFirst)) break;
+  } while (millis()-startMS < DIRECTORYMAPSWITCHMS);
+  return first;
+}
@@ -0,0 +1,64 @@
+/**
+ * Class: DFR0534DirectoryMap
+ *
+ * Description:
+ * Map of the visited directories on a DFR0534 audio module for browsing
+ * directories without repeated requests
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534DirectoryMap.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/** Maximum number of directories in the map */
+#define DFR0534DIRECTORYMAPSIZE 16
+
+/**@brief
+ * Class for remembering the file ranges of directories on a DFR0534 audio module
+ */
+class DFR0534DirectoryMap {
+  public:
+    /**@brief
+     * Constructor of a directory map
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534DirectoryMap(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+    }
+    void clear();
+    int findDirectory(word track);
+    byte getCount();
+    int getCurrent();
+    bool getDirectory(byte index, word &first, word &count);
+    word getHitCount();
+    word getQueryCount();
+    int learn();
+    bool playDirectory(byte index);
+    bool playLastInDirectory();
+    bool playNextDirectory();
+  private:
+    int waitForDirectory(int previousFirst);
+    struct RANGE {
+      word first;
+      word count;
+    };
+    RANGE m_ranges[DFR0534DIRECTORYMAPSIZE];
+    byte m_count = 0;
+    word m_currentFirst = 0;
+    word m_hitCount = 0;
+    word m_queryCount = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,283 @@
+/**
+ * Class: DFR0534DriveContext
+ *
+ * Description:
+ * Playback contexts per drive for switching drives on a DFR0534 audio module
+ * without losing the position
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - A context stores file number, position, playing state, first file and file count
+ *   of the directory and the file count of the drive. The file counts are only requested,
+ *   when the file has changed since the last save()
+ * - The position is taken from DFR0534::getLastRuntime() like in DFR0534Journal, so
+ *   DFR0534::startSendingRuntime() and DFR0534::pollRuntime() (or getRuntime()) are
+ *   needed for resuming within a file. Only runtimes received after the last switchDrive()
+ *   are used, because older runtimes can belong to the previous drive
+ * - switchDrive() requests DFR0534::getDrivesStates() first and never selects an offline
+ *   drive. Then it saves the context of the selected drive, sends DFR0534::setDrive() and
+ *   restores the context of the new drive with DFR0534::playFileByNumber() or
+ *   DFR0534::prepareFileByNumber(). switchDrive() does not wait for the module to start
+ *   the file. DFR0534::fastForwardDuration() to the stored position is sent by tick()
+ *   DRIVECONTEXTSTARTUPMS later
+ * - After a USB drive or SD card was removed, its context belongs to the old content.
+ *   Call clear(drive), for example from DFR0534DriveMonitor::onDriveRemoved()
+ * - After switchDrive() the getters return the stored context of the new drive without
+ *   serial communication
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534DriveContext.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534DriveContext.h"
+
+// Maximum age of DFR0534::getLastRuntime() for the position
+#define DRIVECONTEXTRUNTIMEAGEMS 2500
+// Time the audio module needs to start a file before fast forward
+#define DRIVECONTEXTSTARTUPMS 100
+
+/**@brief
+ * Remove the contexts of all drives
+ */
+void DFR0534DriveContext::clear()
+{
+  for (byte i=0;i<DFR0534::DRIVEUNKNOWN;i++) m_contexts[i].valid = false;
+  m_seekPosition = 0;
+}
+
+/**@brief
+ * Remove the context of a drive
+ *
+ * Should be called, when the content of the drive has changed,
+ * for example by DFR0534DriveMonitor::onDriveRemoved()
+ *
+ * @param[in] drive  Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH
+ */
+void DFR0534DriveContext::clear(byte drive)
+{
+  if (drive >= DFR0534::DRIVEUNKNOWN) return;
+  m_contexts[drive].valid = false;
+  if ((m_ptrAudio != NULL) && (m_ptrAudio->getSelectedDrive() == drive)) m_seekPosition = 0;
+}
+
+/**@brief
+ * Get stored file number of the selected drive without serial communication
+ *
+ * @returns File number (0 = unknown)
+ */
+word DFR0534DriveContext::getFileNumber()
+{
+  CONTEXT *context = getSelected();
+  if (context == NULL) return 0;
+  return context->track;
+}
+
+/**@brief
+ * Get stored first file number in the directory of the stored file without serial communication
+ *
+ * @returns File number
+ * @retval -1  Unknown
+ */
+int DFR0534DriveContext::getFirstFileNumberInCurrentDirectory()
+{
+  CONTEXT *context = getSelected();
+  if (context == NULL) return -1;
+  return context->first;
+}
+
+/**@brief
+ * Get stored position in the stored file of the selected drive without serial communication
+ *
+ * @returns Position in seconds
+ */
+word DFR0534DriveContext::getPosition()
+{
+  CONTEXT *context = getSelected();
+  if (context == NULL) return 0;
+  return context->position;
+}
+
+/**@brief
+ * Get number of switchDrive() calls, which were rejected because the drive was offline
+ *
+ * @returns Number of rejected switches
+ */
+word DFR0534DriveContext::getRejectedCount()
+{
+  return m_rejectedCount;
+}
+
+/**@brief
+ * Get number of frames sent by the last switchDrive()
+ *
+ * Includes the delayed seek sent by tick()
+ *
+ * @returns Number of frames
+ */
+word DFR0534DriveContext::getSwitchFrames()
+{
+  return m_switchFrames;
+}
+
+/**@brief
+ * Get duration of the last switchDrive()
+ *
+ * Includes the delayed seek sent by tick()
+ *
+ * @returns Duration in ms
+ */
+unsigned long DFR0534DriveContext::getSwitchMS()
+{
+  return m_switchMS;
+}
+
+/**@brief
+ * Get stored file count of the selected drive without serial communication
+ *
+ * @returns File count
+ * @retval -1  Unknown
+ */
+int DFR0534DriveContext::getTotalFiles()
+{
+  CONTEXT *context = getSelected();
+  if (context == NULL) return -1;
+  return context->totalCount;
+}
+
+/**@brief
+ * Get stored file count in the directory of the stored file without serial communication
+ *
+ * @returns File count
+ * @retval -1  Unknown
+ */
+int DFR0534DriveContext::getTotalFilesInCurrentDirectory()
+{
+  CONTEXT *context = getSelected();
+  if (context == NULL) return -1;
+  return context->directoryCount;
+}
+
+/**@brief
+ * Store the context of the selected drive
+ *
+ * Called by switchDrive(). Can also be called before the sketch uses the getters.
+ *
+ * @retval true  Context stored
+ * @retval false Drive or file unknown or request failed
+ */
+bool DFR0534DriveContext::save()
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  byte drive = m_ptrAudio->getSelectedDrive();
+  if (drive >= DFR0534::DRIVEUNKNOWN) drive = m_ptrAudio->getDrive();
+  if (drive >= DFR0534::DRIVEUNKNOWN) return false;
+
+  byte status = m_ptrAudio->getStatus();
+  if (status == DFR0534::STATUSUNKNOWN) return false;
+  word track = m_ptrAudio->getFileNumber();
+  if (track == 0) return false;
+
+  CONTEXT &context = m_contexts[drive];
+  if (!context.valid || (track != context.track)) {
+    int first = m_ptrAudio->getFirstFileNumberInCurrentDirectory();
+    int directoryCount = m_ptrAudio->getTotalFilesInCurrentDirectory();
+    int totalCount = m_ptrAudio->getTotalFiles();
+    if ((first < 0) || (directoryCount < 0) || (totalCount < 0)) return false;
+    context.first = first;
+    context.directoryCount = directoryCount;
+    context.totalCount = totalCount;
+    context.position = 0;
+  }
+  context.track = track;
+  context.playing = (status == DFR0534::PLAYING);
+  if (status == DFR0534::STOPPED) context.position = 0;
+  /* Runtimes received before the last switchDrive() can belong to the previous drive,
+   * runtimes before the delayed seek are not the stored position
+   */
+  unsigned long runtimeMS = m_ptrAudio->getLastRuntimeMS();
+  if ((status == DFR0534::PLAYING) && (m_seekPosition == 0) && (runtimeMS != 0) && ((long)(runtimeMS-m_lastSwitchMS) > 0) &&
+    (millis()-runtimeMS < DRIVECONTEXTRUNTIMEAGEMS)) {
+    unsigned long position = m_ptrAudio->getLastRuntime();
+    context.position = (position > 0xffff) ? 0xffff : position;
+  }
+  context.valid = true;
+  return true;
+}
+
+/**@brief
+ * Switch to another drive and continue at the stored position of this drive
+ *
+ * @param[in] drive  Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH
+ *
+ * @retval true  Drive selected
+ * @retval false Invalid drive, drive offline or request failed
+ */
+bool DFR0534DriveContext::switchDrive(byte drive)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if (drive >= DFR0534::DRIVEUNKNOWN) return false;
+  unsigned long startMS = millis();
+  word startFrames = m_ptrAudio->getSentFrames();
+
+  byte states = m_ptrAudio->getDrivesStates();
+  if ((states == DFR0534::DRIVEUNKNOWN) || ((states & (1 << drive)) == 0)) {
+    m_rejectedCount++;
+    return false;
+  }
+  if (m_ptrAudio->getSelectedDrive() == drive) return true;
+
+  save();
+  m_switchStartMS = startMS;
+  m_switchStartFrames = startFrames;
+  m_seekPosition = 0;
+  m_ptrAudio->setDrive(drive);
+  m_lastSwitchMS = millis();
+  CONTEXT &context = m_contexts[drive];
+  if (context.valid) {
+    if (context.playing) {
+      m_ptrAudio->playFileByNumber(context.track);
+      // Seek is sent by tick(), when the module has started the file
+      m_seekPosition = context.position;
+    } else m_ptrAudio->prepareFileByNumber(context.track);
+  }
+
+  m_switchFrames = m_ptrAudio->getSentFrames()-m_switchStartFrames;
+  m_switchMS = millis()-m_switchStartMS;
+  return true;
+}
+
+/**@brief
+ * Send the delayed seek of switchDrive()
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534DriveContext::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (m_seekPosition == 0) return;
+  if (millis()-m_lastSwitchMS < DRIVECONTEXTSTARTUPMS) return;
+  m_ptrAudio->fastForwardDuration(m_seekPosition);
+  m_seekPosition = 0;
+  m_switchFrames = m_ptrAudio->getSentFrames()-m_switchStartFrames;
+  m_switchMS = millis()-m_switchStartMS;
+}
+
+/**@brief
+ * Get context of the selected drive
+ *
+ * @returns Context or NULL, when no valid context exists
+ */
+DFR0534DriveContext::CONTEXT *DFR0534DriveContext::getSelected()
+{
+  if (m_ptrAudio == NULL) return NULL; // Should not happen
+  byte drive = m_ptrAudio->getSelectedDrive();
+  if (drive >= DFR0534::DRIVEUNKNOWN) return NULL;
+  if (!m_contexts[drive].valid) return NULL;
+  return &m_contexts[drive];
+}
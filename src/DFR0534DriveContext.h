@@ -0,0 +1,72 @@
+/**
+ * Class: DFR0534DriveContext
+ *
+ * Description:
+ * Playback contexts per drive for switching drives on a DFR0534 audio module
+ * without losing the position
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534DriveContext.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/**@brief
+ * Class for remembering file, position and file counts per drive of a DFR0534 audio module
+ */
+class DFR0534DriveContext {
+  public:
+    /**@brief
+     * Constructor of drive contexts
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534DriveContext(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+      clear();
+    }
+    void clear();
+    void clear(byte drive);
+    word getFileNumber();
+    int getFirstFileNumberInCurrentDirectory();
+    word getPosition();
+    word getRejectedCount();
+    word getSwitchFrames();
+    unsigned long getSwitchMS();
+    int getTotalFiles();
+    int getTotalFilesInCurrentDirectory();
+    bool save();
+    bool switchDrive(byte drive);
+    void tick();
+  private:
+    struct CONTEXT {
+      word track;
+      word position;
+      word first;
+      word directoryCount;
+      word totalCount;
+      bool playing;
+      bool valid;
+    };
+    CONTEXT *getSelected();
+    CONTEXT m_contexts[DFR0534::DRIVEUNKNOWN];
+    word m_rejectedCount = 0;
+    word m_switchFrames = 0;
+    unsigned long m_switchMS = 0;
+    unsigned long m_lastSwitchMS = 0;
+    word m_switchStartFrames = 0;
+    unsigned long m_switchStartMS = 0;
+    word m_seekPosition = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,159 @@
+/**
+ * Class: DFR0534DriveMonitor
+ *
+ * Description:
+ * Background monitor for inserted and removed drives of a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - tick() requests DFR0534::getDrivesStates() only, when no other frame was
+ *   sent to the audio module for DRIVEMONITORIDLEMS, to keep out of the way of
+ *   requests from the sketch
+ * - The poll interval starts with DRIVEMONITORMINPOLLMS and is doubled up to
+ *   DRIVEMONITORMAXPOLLMS as long as the drives do not change
+ * - The bit pattern 3 (USB drive and SD card online, flash offline) cannot be
+ *   distinguished from a failed request (DFR0534::DRIVEUNKNOWN) and is ignored
+ * - When the selected drive is removed, the removed callback should invalidate
+ *   all data cached for this drive
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534DriveMonitor.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534DriveMonitor.h"
+
+// Minimum time without other frames before a poll
+#define DRIVEMONITORIDLEMS 200
+// Poll interval after a change
+#define DRIVEMONITORMINPOLLMS 1000
+// Maximum poll interval without changes
+#define DRIVEMONITORMAXPOLLMS 16000
+
+/**@brief
+ * Get last known drive states
+ *
+ * Bit pattern like DFR0534::getDrivesStates(), but without serial communication
+ *
+ * @returns Bit pattern for drives
+ * @retval DFR0534::DRIVEUNKNOWN  Drive states not yet known
+ */
+byte DFR0534DriveMonitor::getDrivesStates()
+{
+  return m_drivesStates;
+}
+
+/**@brief
+ * Get current poll interval
+ *
+ * @returns Interval in ms
+ */
+unsigned long DFR0534DriveMonitor::getPollInterval()
+{
+  return m_pollIntervalMS;
+}
+
+/**@brief
+ * Get number of DFR0534::getDrivesStates() requests sent by the monitor
+ *
+ * @returns Number of requests
+ */
+word DFR0534DriveMonitor::getPollCount()
+{
+  return m_pollCount;
+}
+
+/**@brief
+ * Checks whether a drive was online at the last poll
+ *
+ * @param[in] drive  Drive DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH
+ *
+ * @retval true  Drive is online
+ * @retval false Drive is offline or drive states not yet known
+ */
+bool DFR0534DriveMonitor::isOnline(byte drive)
+{
+  if (drive >= DFR0534::DRIVEUNKNOWN) return false;
+  if (m_drivesStates == DFR0534::DRIVEUNKNOWN) return false;
+  return (m_drivesStates & (1 << drive)) != 0;
+}
+
+/**@brief
+ * Set function, which is called when a drive goes online
+ *
+ * @param[in] callback  Function with the drive (DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH) as parameter, NULL = none
+ */
+void DFR0534DriveMonitor::onDriveInserted(void (*callback)(byte drive))
+{
+  m_insertedCallback = callback;
+}
+
+/**@brief
+ * Set function, which is called when a drive goes offline
+ *
+ * The function should invalidate all data cached for this drive
+ *
+ * @param[in] callback  Function with the drive (DFR0534::DRIVEUSB, DFR0534::DRIVESD or DFR0534::DRIVEFLASH) as parameter, NULL = none
+ */
+void DFR0534DriveMonitor::onDriveRemoved(void (*callback)(byte drive))
+{
+  m_removedCallback = callback;
+}
+
+/**@brief
+ * Switch to DFR0534::DRIVEFLASH, when the selected drive goes offline
+ *
+ * @param[in] enabled  true = Switch to flash memory, false = Do nothing (=default)
+ */
+void DFR0534DriveMonitor::setFallbackToFlash(bool enabled)
+{
+  m_fallbackToFlash = enabled;
+}
+
+/**@brief
+ * Poll drive states in the background and call the callbacks on changes
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534DriveMonitor::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  unsigned long nowMS = millis();
+  if ((m_pollCount > 0) && (nowMS-m_lastPollMS < m_pollIntervalMS)) return;
+  if (nowMS-m_ptrAudio->getLastSendMS() < DRIVEMONITORIDLEMS) return; // Serial connection in use
+
+  byte states = m_ptrAudio->getDrivesStates();
+  m_lastPollMS = millis();
+  m_pollCount++;
+
+  // Back off, when nothing has changed or request failed
+  if ((states == DFR0534::DRIVEUNKNOWN) || (states == m_drivesStates)) {
+    m_pollIntervalMS *= 2;
+    if (m_pollIntervalMS < DRIVEMONITORMINPOLLMS) m_pollIntervalMS = DRIVEMONITORMINPOLLMS;
+    if (m_pollIntervalMS > DRIVEMONITORMAXPOLLMS) m_pollIntervalMS = DRIVEMONITORMAXPOLLMS;
+    return;
+  }
+  m_pollIntervalMS = DRIVEMONITORMINPOLLMS;
+
+  byte previousStates = m_drivesStates;
+  m_drivesStates = states;
+  if (previousStates == DFR0534::DRIVEUNKNOWN) return; // First successful poll
+
+  for (byte drive=DFR0534::DRIVEUSB;drive<DFR0534::DRIVEUNKNOWN;drive++) {
+    bool wasOnline = (previousStates & (1 << drive)) != 0;
+    bool isOnline = (states & (1 << drive)) != 0;
+    if (wasOnline && !isOnline) {
+      if (m_removedCallback != NULL) m_removedCallback(drive);
+      if (m_fallbackToFlash && (drive != DFR0534::DRIVEFLASH) &&
+        (m_ptrAudio->getSelectedDrive() == drive) && ((states & (1 << DFR0534::DRIVEFLASH)) != 0)) {
+        m_ptrAudio->setDrive(DFR0534::DRIVEFLASH);
+      }
+    }
+    if (!wasOnline && isOnline && (m_insertedCallback != NULL)) m_insertedCallback(drive);
+  }
+}
@@ -0,0 +1,54 @@
+/**
+ * Class: DFR0534DriveMonitor
+ *
+ * Description:
+ * Background monitor for inserted and removed drives of a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534DriveMonitor.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/**@brief
+ * Class for detecting inserted and removed drives (USB drive, SD card) of a DFR0534 audio module
+ */
+class DFR0534DriveMonitor {
+  public:
+    /**@brief
+     * Constructor of a drive monitor
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534DriveMonitor(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+    }
+    byte getDrivesStates();
+    unsigned long getPollInterval();
+    word getPollCount();
+    bool isOnline(byte drive);
+    void onDriveInserted(void (*callback)(byte drive));
+    void onDriveRemoved(void (*callback)(byte drive));
+    void setFallbackToFlash(bool enabled);
+    void tick();
+  private:
+    DFR0534 *m_ptrAudio = NULL;
+    void (*m_insertedCallback)(byte drive) = NULL;
+    void (*m_removedCallback)(byte drive) = NULL;
+    bool m_fallbackToFlash = false;
+    byte m_drivesStates = DFR0534::DRIVEUNKNOWN;
+    unsigned long m_pollIntervalMS = 0;
+    unsigned long m_lastPollMS = 0;
+    word m_pollCount = 0;
+};
@@ -0,0 +1,214 @@
+/**
+ * Class: DFR0534Fader
+ *
+ * Description:
+ * Non-blocking volume fades for a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - tick() has to be called frequently from loop() and sends a setVolume() frame
+ *   only, when the volume level of the fade curve has changed
+ * - A setVolume() frame has 5 bytes and needs about 5ms at 9600 baud.
+ *   When the curve changes faster than frames can be sent, the
+ *   intermediate levels are skipped and the current level of the curve is sent
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Fader.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Fader.h"
+
+// Minimum time between two setVolume() frames (5 bytes at 9600 baud)
+#define FADERFRAMEMS 6
+// Fixed point scale for the fade progress
+#define FADERSCALE 1024UL
+
+/**@brief
+ * Start a fade from the current volume level to a new level
+ *
+ * @param[in] level       Target volume level (0 = mute, 30 = max)
+ * @param[in] durationMS  Duration of the fade in ms (0 = set level immediately)
+ * @param[in] curve       Fade curve: DFR0534Fader::CURVELINEAR (=default), DFR0534Fader::CURVEEASEIN or DFR0534Fader::CURVEEASEOUT
+ *
+ * @retval true  Fade started
+ * @retval false Invalid parameter
+ */
+bool DFR0534Fader::fadeTo(byte level, unsigned long durationMS, byte curve)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if (curve >= CURVEUNKNOWN) return false;
+  if (level > 30) level = 30;
+
+  m_startLevel = m_ptrAudio->getVolume();
+  m_targetLevel = level;
+  m_curve = curve;
+  m_durationMS = durationMS;
+  m_startMS = millis();
+  m_fading = true;
+  tick();
+  return true;
+}
+
+/**@brief
+ * Fade to a lower volume level and remember the current level for restore()
+ *
+ * @param[in] level       Volume level while ducked
+ * @param[in] durationMS  Duration of the fade in ms
+ */
+void DFR0534Fader::duck(byte level, unsigned long durationMS)
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (m_duckedLevel == 0xff) m_duckedLevel = m_fading ? m_targetLevel : m_ptrAudio->getVolume();
+  fadeTo(level, durationMS, CURVEEASEOUT);
+}
+
+/**@brief
+ * Fade back to the volume level before duck()
+ *
+ * @param[in] durationMS  Duration of the fade in ms
+ */
+void DFR0534Fader::restore(unsigned long durationMS)
+{
+  if (m_duckedLevel == 0xff) return;
+  fadeTo(m_duckedLevel, durationMS, CURVEEASEIN);
+  m_duckedLevel = 0xff;
+}
+
+/**@brief
+ * Get number of setVolume() frames sent by the fader
+ *
+ * @returns Number of frames
+ */
+word DFR0534Fader::getFrameCount()
+{
+  return m_frameCount;
+}
+
+/**@brief
+ * Get current volume level of the audio module
+ *
+ * @returns Volume level
+ */
+byte DFR0534Fader::getLevel()
+{
+  if (m_ptrAudio == NULL) return 0; // Should not happen
+  return m_ptrAudio->getVolume();
+}
+
+/**@brief
+ * Get number of volume steps, which were skipped because the serial connection was too slow
+ *
+ * @returns Number of skipped steps
+ */
+word DFR0534Fader::getSkippedCount()
+{
+  return m_skippedCount;
+}
+
+/**@brief
+ * Get target volume level of the current or last fade
+ *
+ * @returns Volume level
+ */
+byte DFR0534Fader::getTargetLevel()
+{
+  return m_targetLevel;
+}
+
+/**@brief
+ * Checks whether a fade is running
+ *
+ * @retval true  Fade is running
+ * @retval false No fade
+ */
+bool DFR0534Fader::isFading()
+{
+  return m_fading;
+}
+
+/**@brief
+ * Stop fade and set volume level immediately
+ *
+ * @param[in] level  Volume level (0 = mute, 30 = max)
+ */
+void DFR0534Fader::setLevel(byte level)
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (level > 30) level = 30;
+  m_fading = false;
+  m_targetLevel = level;
+  sendLevel(level);
+}
+
+/**@brief
+ * Stop fade at the current volume level
+ */
+void DFR0534Fader::stop()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  m_fading = false;
+  m_targetLevel = m_ptrAudio->getVolume();
+}
+
+/**@brief
+ * Send the volume level of the fade curve, when it has changed
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Fader::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (!m_fading) return;
+
+  unsigned long nowMS = millis();
+  unsigned long elapsedMS = nowMS-m_startMS;
+  byte level;
+  if (elapsedMS >= m_durationMS) {
+    level = m_targetLevel;
+  } else {
+    // Progress 0...FADERSCALE without overflow for long fades
+    unsigned long progress;
+    if (m_durationMS < 0x3FFFFFUL) progress = (elapsedMS*FADERSCALE)/m_durationMS;
+    else progress = elapsedMS/(m_durationMS/FADERSCALE);
+    if (progress > FADERSCALE) progress = FADERSCALE;
+
+    switch (m_curve) {
+      case CURVEEASEIN:
+        progress = (progress*progress)/FADERSCALE;
+        break;
+      case CURVEEASEOUT:
+        progress = FADERSCALE-((FADERSCALE-progress)*(FADERSCALE-progress))/FADERSCALE;
+        break;
+    }
+    int delta = (int)m_targetLevel-(int)m_startLevel;
+    if (delta >= 0) level = m_startLevel+(byte)((delta*progress+FADERSCALE/2)/FADERSCALE);
+    else level = m_startLevel-(byte)((-delta*progress+FADERSCALE/2)/FADERSCALE);
+  }
+
+  byte currentLevel = m_ptrAudio->getVolume();
+  if (level != currentLevel) {
+    if ((m_frameCount > 0) && (nowMS-m_lastFrameMS < FADERFRAMEMS)) return; // Serial connection still busy
+    byte steps = (level > currentLevel) ? level-currentLevel : currentLevel-level;
+    m_skippedCount += steps-1;
+    sendLevel(level);
+  }
+  if (m_ptrAudio->getVolume() == m_targetLevel) m_fading = false;
+}
+
+/**@brief
+ * Send volume level to the audio module
+ *
+ * @param[in] level  Volume level
+ */
+void DFR0534Fader::sendLevel(byte level)
+{
+  m_ptrAudio->setVolume(level);
+  m_lastFrameMS = millis();
+  m_frameCount++;
+}
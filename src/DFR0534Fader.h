@@ -0,0 +1,72 @@
+/**
+ * Class: DFR0534Fader
+ *
+ * Description:
+ * Non-blocking volume fades for a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Fader.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/**@brief
+ * Class for non-blocking volume fades on a DFR0534 audio module
+ */
+class DFR0534Fader {
+  public:
+    /** Fade curves */
+    enum DFR0534CURVE
+    {
+      CURVELINEAR, /**< Constant volume change */
+      CURVEEASEIN, /**< Slow start, fast end (quadratic) */
+      CURVEEASEOUT, /**< Fast start, slow end (quadratic) */
+      CURVEUNKNOWN /**< Unknown */
+    };
+    /**@brief
+     * Constructor of a volume fader
+     *
+     * The fader starts from the volume level returned by DFR0534::getVolume()
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534Fader(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+      m_targetLevel = audio.getVolume();
+    }
+    void duck(byte level, unsigned long durationMS);
+    bool fadeTo(byte level, unsigned long durationMS, byte curve=CURVELINEAR);
+    word getFrameCount();
+    byte getLevel();
+    word getSkippedCount();
+    byte getTargetLevel();
+    bool isFading();
+    void restore(unsigned long durationMS);
+    void setLevel(byte level);
+    void stop();
+    void tick();
+  private:
+    void sendLevel(byte level);
+    byte m_startLevel = 0;
+    byte m_targetLevel;
+    byte m_duckedLevel = 0xff;
+    byte m_curve = CURVELINEAR;
+    bool m_fading = false;
+    unsigned long m_startMS = 0;
+    unsigned long m_durationMS = 0;
+    unsigned long m_lastFrameMS = 0;
+    word m_frameCount = 0;
+    word m_skippedCount = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,270 @@
+/**
+ * Class: DFR0534History
+ *
+ * Description:
+ * Playback history and play counters for a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - tick() requests DFR0534::getStatus() and while playing DFR0534::getFileNumber()
+ *   every HISTORYPOLLMS and records starts, stops and timeouts. Inserts and errors of the
+ *   sketch can be added with record()
+ * - After record(EVENTINSERT) tick() records no EVENTSTART for the inserted file and for
+ *   the interrupted file, when playback returns to it
+ * - record() needs constant time and no dynamic memory. When the ring buffer is full,
+ *   the oldest event is dropped
+ * - Play counts are stored in a count-min sketch with two rows of DFR0534HISTORYCOUNTERS
+ *   saturating 16 bit counters. The first row uses the file number modulo the row size,
+ *   so counts are exact for file numbers up to DFR0534HISTORYCOUNTERS. For larger drives
+ *   a count can be too high, but never too low
+ *
+ * History format (written by dump()):
+ * - 4 bytes "DFRH"
+ * - 1 byte format version (DFR0534HISTORYVERSION)
+ * - 1 byte number of events
+ * - Events from the oldest to the newest event:
+ *   - 1 byte event (DFR0534History::DFR0534EVENT)
+ *   - 2 bytes file number (big endian)
+ *   - 4 bytes millis() of the event (big endian)
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534History.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534History.h"
+
+// Interval for status requests
+#define HISTORYPOLLMS 500
+// Minimum time without other frames before a request
+#define HISTORYIDLEMS 200
+
+/**@brief
+ * Remove all events and play counts
+ */
+void DFR0534History::clear()
+{
+  m_head = 0;
+  m_used = 0;
+  m_droppedCount = 0;
+  for (byte i=0;i<DFR0534HISTORYCOUNTERS;i++) {
+    m_counters[0][i] = 0;
+    m_counters[1][i] = 0;
+  }
+}
+
+/**@brief
+ * Write events in binary format to an output, for example Serial
+ *
+ * @param[in] output  Output for the events
+ */
+void DFR0534History::dump(Print &output)
+{
+  output.write((const uint8_t *)"DFRH", 4);
+  output.write((byte)DFR0534HISTORYVERSION);
+  output.write(m_used);
+  for (byte i=0;i<m_used;i++) {
+    EVENT &event = m_events[(m_head+DFR0534HISTORYSIZE-m_used+i) % DFR0534HISTORYSIZE];
+    output.write(event.event);
+    output.write((byte)(event.track >> 8));
+    output.write((byte)(event.track & 0xff));
+    for (int shift=24;shift>=0;shift-=8) output.write((byte)((event.timeMS >> shift) & 0xff));
+  }
+}
+
+/**@brief
+ * Write events as CSV with the columns ms, event and file to an output, for example Serial
+ *
+ * @param[in] output  Output for the events
+ */
+void DFR0534History::dumpCSV(Print &output)
+{
+  output.println(F("ms,event,file"));
+  for (byte i=0;i<m_used;i++) {
+    EVENT &event = m_events[(m_head+DFR0534HISTORYSIZE-m_used+i) % DFR0534HISTORYSIZE];
+    output.print(event.timeMS);
+    output.print(',');
+    switch (event.event) {
+      case EVENTSTART: output.print(F("start")); break;
+      case EVENTSTOP: output.print(F("stop")); break;
+      case EVENTINSERT: output.print(F("insert")); break;
+      case EVENTERROR: output.print(F("error")); break;
+      case EVENTTIMEOUT: output.print(F("timeout")); break;
+      default: output.print(event.event);
+    }
+    output.print(',');
+    output.println(event.track);
+  }
+}
+
+/**@brief
+ * Write play counts as CSV with the columns file and count to an output, for example Serial
+ *
+ * Files without plays are skipped.
+ *
+ * @param[in] output     Output for the play counts
+ * @param[in] firstFile  First file number
+ * @param[in] lastFile   Last file number
+ */
+void DFR0534History::dumpCounts(Print &output, word firstFile, word lastFile)
+{
+  output.println(F("file,count"));
+  for (unsigned long track=firstFile;track<=lastFile;track++) {
+    word count = getPlayCount(track);
+    if (count == 0) continue;
+    output.print(track);
+    output.print(',');
+    output.println(count);
+  }
+}
+
+/**@brief
+ * Get number of events dropped, because the ring buffer was full
+ *
+ * @returns Number of dropped events
+ */
+unsigned long DFR0534History::getDroppedCount()
+{
+  return m_droppedCount;
+}
+
+/**@brief
+ * Get an event
+ *
+ * @param[in] index    Event number (0 = oldest event)
+ * @param[out] event   Event like DFR0534History::EVENTSTART
+ * @param[out] track   File number (0 = unknown)
+ * @param[out] timeMS  millis() of the event
+ *
+ * @retval true  Event found
+ * @retval false Invalid event number
+ */
+bool DFR0534History::getEvent(byte index, byte &event, word &track, unsigned long &timeMS)
+{
+  if (index >= m_used) return false;
+  EVENT &entry = m_events[(m_head+DFR0534HISTORYSIZE-m_used+index) % DFR0534HISTORYSIZE];
+  event = entry.event;
+  track = entry.track;
+  timeMS = entry.timeMS;
+  return true;
+}
+
+/**@brief
+ * Get number of events in the ring buffer
+ *
+ * @returns Number of events
+ */
+byte DFR0534History::getLength()
+{
+  return m_used;
+}
+
+/**@brief
+ * Get number of starts for a file
+ *
+ * @param[in] track  File number
+ *
+ * @returns Number of starts (65535 = 65535 or more)
+ */
+word DFR0534History::getPlayCount(word track)
+{
+  word count = m_counters[0][track % DFR0534HISTORYCOUNTERS];
+  word other = m_counters[1][counterIndex(track)];
+  return (other < count) ? other : count;
+}
+
+/**@brief
+ * Add an event
+ *
+ * EVENTSTART and EVENTINSERT increase the play count of the file.
+ * After EVENTINSERT the file playing before the insert is not recorded again by tick(), when playback returns to it.
+ *
+ * @param[in] event  Event like DFR0534History::EVENTINSERT
+ * @param[in] track  File number (0 = unknown)
+ */
+void DFR0534History::record(byte event, word track)
+{
+  if (m_used == DFR0534HISTORYSIZE) m_droppedCount++; else m_used++;
+  EVENT &entry = m_events[m_head];
+  entry.timeMS = millis();
+  entry.track = track;
+  entry.event = event;
+  m_head = (m_head+1) % DFR0534HISTORYSIZE;
+
+  if (event == EVENTINSERT) {
+    m_insertedTrack = track;
+    m_interruptedTrack = ((m_lastStatus == DFR0534::PLAYING) || (m_lastStatus == DFR0534::PAUSED)) ? m_lastTrack : 0;
+  }
+
+  if ((track > 0) && ((event == EVENTSTART) || (event == EVENTINSERT))) {
+    word &count = m_counters[0][track % DFR0534HISTORYCOUNTERS];
+    if (count < 0xffff) count++;
+    word &other = m_counters[1][counterIndex(track)];
+    if (other < 0xffff) other++;
+  }
+}
+
+/**@brief
+ * Record starts, stops and timeouts of the audio module
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534History::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  unsigned long nowMS = millis();
+  if (nowMS-m_lastPollMS < HISTORYPOLLMS) return;
+  if (nowMS-m_ptrAudio->getLastSendMS() < HISTORYIDLEMS) return; // Serial connection in use
+  m_lastPollMS = nowMS;
+
+  byte status = m_ptrAudio->getStatus();
+  if (status == DFR0534::STATUSUNKNOWN) {
+    if (!m_timeout) record(EVENTTIMEOUT, m_lastTrack);
+    m_timeout = true;
+    return;
+  }
+  m_timeout = false;
+
+  if (status == DFR0534::PLAYING) {
+    int track = m_ptrAudio->getFileNumber();
+    if (track <= 0) return; // Try again later
+    if ((m_lastStatus != DFR0534::PLAYING) && (m_lastStatus != DFR0534::PAUSED)) record(EVENTSTART, track);
+    else if (track != m_lastTrack) {
+      if ((track == m_insertedTrack) && (m_insertedTrack != 0)) {
+        // Already recorded by EVENTINSERT
+      } else if ((track == m_interruptedTrack) && (m_interruptedTrack != 0)) {
+        // Playback returns to the file interrupted by the insert
+        m_insertedTrack = 0;
+        m_interruptedTrack = 0;
+      } else {
+        m_insertedTrack = 0;
+        m_interruptedTrack = 0;
+        record(EVENTSTART, track);
+      }
+    }
+    m_lastTrack = track;
+  } else if ((status == DFR0534::STOPPED) && ((m_lastStatus == DFR0534::PLAYING) || (m_lastStatus == DFR0534::PAUSED))) {
+    record(EVENTSTOP, m_lastTrack);
+    m_insertedTrack = 0;
+    m_interruptedTrack = 0;
+  }
+  m_lastStatus = status;
+}
+
+/**@brief
+ * Get counter in the second row of the sketch
+ *
+ * @param[in] track  File number
+ *
+ * @returns Counter index
+ */
+byte DFR0534History::counterIndex(word track)
+{
+  unsigned long hash = (track * 0x9E3779B1UL) & 0xffffffffUL;
+  return (hash >> 16) % DFR0534HISTORYCOUNTERS;
+}
@@ -0,0 +1,83 @@
+/**
+ * Class: DFR0534History
+ *
+ * Description:
+ * Playback history and play counters for a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534History.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/** Number of events in the ring buffer */
+#define DFR0534HISTORYSIZE 16
+/** Number of play counters per row (counts are exact for file numbers up to this value) */
+#define DFR0534HISTORYCOUNTERS 32
+/** History format version written by DFR0534History::dump() */
+#define DFR0534HISTORYVERSION 1
+
+/**@brief
+ * Class for recording playback events and play counts of a DFR0534 audio module
+ */
+class DFR0534History {
+  public:
+    /** Events */
+    enum DFR0534EVENT
+    {
+      EVENTSTART, /**< File started */
+      EVENTSTOP, /**< Playback stopped */
+      EVENTINSERT, /**< File inserted */
+      EVENTERROR, /**< Error */
+      EVENTTIMEOUT /**< Audio module does not respond */
+    };
+    /**@brief
+     * Constructor of a history
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534History(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+      clear();
+    }
+    void clear();
+    void dump(Print &output);
+    void dumpCSV(Print &output);
+    void dumpCounts(Print &output, word firstFile, word lastFile);
+    unsigned long getDroppedCount();
+    bool getEvent(byte index, byte &event, word &track, unsigned long &timeMS);
+    byte getLength();
+    word getPlayCount(word track);
+    void record(byte event, word track=0);
+    void tick();
+  private:
+    struct EVENT {
+      unsigned long timeMS;
+      word track;
+      byte event;
+    };
+    byte counterIndex(word track);
+    EVENT m_events[DFR0534HISTORYSIZE];
+    byte m_head = 0;
+    byte m_used = 0;
+    unsigned long m_droppedCount = 0;
+    word m_counters[2][DFR0534HISTORYCOUNTERS];
+    byte m_lastStatus = DFR0534::STATUSUNKNOWN;
+    word m_lastTrack = 0;
+    word m_insertedTrack = 0;
+    word m_interruptedTrack = 0;
+    bool m_timeout = false;
+    unsigned long m_lastPollMS = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,393 @@
+/**
+ * Class: DFR0534Journal
+ *
+ * Description:
+ * Wear leveled playback journal in EEPROM for resuming a DFR0534 audio module after a reset
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - The journal is a ring of records in the EEPROM. Every write goes to the next
+ *   record with an increased sequence number, so every EEPROM cell is only written
+ *   for every n-th checkpoint. The newest valid record is found by the sequence number
+ * - A record has a checksum. A record, which was only partly written during a power
+ *   loss, is invalid and the previous record is used
+ * - tick() checks the playback state every JOURNALPOLLMS, when no other frame was sent
+ *   for JOURNALIDLEMS. A record is only written, when the file, the drive, the playing state,
+ *   the volume, the EQ mode or the loop mode has changed, or the runtime has moved by
+ *   more than the position step (30 seconds by default)
+ * - The position is the runtime, which the module sends after DFR0534::startSendingRuntime()
+ *   (restore() enables it). restore() resumes at or a little before the position at the power loss
+ * - On ESP32, ESP8266 and RP2040 EEPROM.begin() has to be called before the journal is used.
+ *   On these boards every write is followed by EEPROM.commit()
+ * - Boards without EEPROM library need DFR0534JOURNALEEPROM 0 (build flag). Then records
+ *   are only kept in RAM and restore() after a reset finds no record
+ * - restore() does not wait for the module to start the file. The seek to the position
+ *   is sent by tick() JOURNALSTARTUPMS later
+ *
+ * Record format (DFR0534JOURNALRECORDSIZE bytes, big endian):
+ * - 2 bytes sequence number
+ * - 2 bytes file number
+ * - 1 byte drive
+ * - 1 byte flags (bit 0 = playing)
+ * - 2 bytes position in seconds
+ * - 1 byte volume
+ * - 1 byte EQ mode
+ * - 1 byte loop mode
+ * - 1 byte checksum (inverted sum of all other bytes)
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Journal.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Journal.h"
+#if DFR0534JOURNALEEPROM
+#include <EEPROM.h>
+#endif
+
+// Interval for checking the playback state
+#define JOURNALPOLLMS 2000
+// Minimum time without other frames before a check
+#define JOURNALIDLEMS 200
+// Maximum age of a runtime used as position
+#define JOURNALRUNTIMEAGEMS 2500
+// Time the audio module needs to start a file before fastForwardDuration() works
+#define JOURNALSTARTUPMS 100
+// Flags in a record
+#define JOURNALPLAYING 1
+
+/**@brief
+ * Invalidate all records
+ */
+void DFR0534Journal::clear()
+{
+#if DFR0534JOURNALEEPROM
+  for (word i=0;i<m_slots*DFR0534JOURNALRECORDSIZE;i++) {
+    if (EEPROM.read(m_address+i) != 0xff) EEPROM.write(m_address+i, 0xff);
+  }
+  commit();
+#endif
+  m_seekPosition = 0;
+  m_loaded = false;
+  load();
+}
+
+/**@brief
+ * Get number of frames sent by the last restore()
+ *
+ * @returns Number of frames
+ */
+word DFR0534Journal::getRestoreFrames()
+{
+  return m_restoreFrames;
+}
+
+/**@brief
+ * Get time needed by the last restore()
+ *
+ * Includes the delayed seek sent by tick()
+ *
+ * @returns Time in ms
+ */
+unsigned long DFR0534Journal::getRestoreMS()
+{
+  return m_restoreMS;
+}
+
+/**@brief
+ * Get sequence number of the newest record
+ *
+ * The sequence number is increased by every write and survives resets,
+ * so it counts all writes (modulo 65536) since the journal was cleared
+ *
+ * @returns Sequence number (0 = no record)
+ */
+word DFR0534Journal::getSequence()
+{
+  if (!m_loaded) load();
+  return m_valid ? m_record.sequence : 0;
+}
+
+/**@brief
+ * Get number of records written since startup
+ *
+ * @returns Number of writes
+ */
+word DFR0534Journal::getWriteCount()
+{
+  return m_writeCount;
+}
+
+/**@brief
+ * Restore the playback state of the newest record
+ *
+ * Should be called once in setup(). Sends only the settings, which differ from the
+ * settings known by the DFR0534 object (the defaults after device startup).
+ * A playing file is started with DFR0534::playFileByNumber(). The position is set by
+ * DFR0534::fastForwardDuration(), which tick() sends JOURNALSTARTUPMS later, so restore() does
+ * not block. A paused or stopped file is selected with DFR0534::prepareFileByNumber().
+ * Enables runtimes with DFR0534::startSendingRuntime() for later checkpoints.
+ *
+ * @retval true  State restored
+ * @retval false No valid record
+ */
+bool DFR0534Journal::restore()
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  m_restoreStartMS = millis();
+  word startFrames = m_ptrAudio->getSentFrames();
+  m_seekPosition = 0;
+  if (!m_loaded) load();
+
+  if (m_valid) {
+    if (m_record.drive < DFR0534::DRIVEUNKNOWN) m_ptrAudio->setDrive(m_record.drive);
+    if (m_record.volume != m_ptrAudio->getVolume()) m_ptrAudio->setVolume(m_record.volume);
+    if (m_record.equalizer != m_ptrAudio->getEqualizer()) m_ptrAudio->setEqualizer(m_record.equalizer);
+    if (m_record.loopMode != m_ptrAudio->getLoopMode()) m_ptrAudio->setLoopMode(m_record.loopMode);
+    if (m_record.track > 0) {
+      if (m_record.flags & JOURNALPLAYING) {
+        m_ptrAudio->playFileByNumber(m_record.track);
+        // Seek is sent by tick(), when the module has started the file
+        m_seekPosition = m_record.position;
+      } else m_ptrAudio->prepareFileByNumber(m_record.track);
+    }
+  }
+  m_ptrAudio->startSendingRuntime();
+
+  m_restoreFrames = m_ptrAudio->getSentFrames()-startFrames;
+  m_restoreMS = millis()-m_restoreStartMS;
+  return m_valid;
+}
+
+/**@brief
+ * Write the current playback state immediately, when anything has changed
+ *
+ * For example before a planned power off
+ */
+void DFR0534Journal::save()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (!m_loaded) load();
+  if (m_seekPosition > 0) return; // Position of the restored file not set yet
+  RECORD record;
+  if (!getState(record)) return;
+  if (m_valid && (record.position == m_record.position) && !isChanged(record)) return;
+  writeRecord(record);
+}
+
+/**@brief
+ * Set how far the runtime has to move before a new record is written
+ *
+ * @param[in] seconds  Position step in seconds (30 = default)
+ */
+void DFR0534Journal::setPositionStep(word seconds)
+{
+  m_positionStep = seconds;
+}
+
+/**@brief
+ * Check the playback state and write a record, when it has changed
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Journal::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (!m_loaded) load();
+  byte hour, minute, second;
+  m_ptrAudio->pollRuntime(hour, minute, second);
+
+  unsigned long nowMS = millis();
+  if (m_seekPosition > 0) {
+    // Delayed seek of restore()
+    if (nowMS-m_restoreStartMS < JOURNALSTARTUPMS) return;
+    m_ptrAudio->fastForwardDuration(m_seekPosition);
+    m_seekPosition = 0;
+    m_restoreFrames++;
+    m_restoreMS = millis()-m_restoreStartMS;
+    m_lastPollMS = nowMS;
+    return;
+  }
+  if (nowMS-m_lastPollMS < JOURNALPOLLMS) return;
+  if (nowMS-m_ptrAudio->getLastSendMS() < JOURNALIDLEMS) return; // Serial connection in use
+  m_lastPollMS = nowMS;
+
+  RECORD record;
+  if (!getState(record)) return;
+  if (m_valid && !isChanged(record)) {
+    word distance = (record.position > m_record.position) ? record.position-m_record.position : m_record.position-record.position;
+    if (distance < m_positionStep) return;
+  }
+  writeRecord(record);
+}
+
+/**@brief
+ * Write changed EEPROM bytes to the flash memory on boards, which emulate the EEPROM
+ */
+void DFR0534Journal::commit()
+{
+#if DFR0534JOURNALEEPROM && (defined(ESP32) || defined(ESP8266) || defined(ARDUINO_ARCH_RP2040))
+  EEPROM.commit();
+#endif
+}
+
+/**@brief
+ * Get current playback state from the audio module
+ *
+ * @param[out] record  Playback state
+ *
+ * @retval true  State received
+ * @retval false Request failed
+ */
+bool DFR0534Journal::getState(RECORD &record)
+{
+  byte status = m_ptrAudio->getStatus();
+  if (status == DFR0534::STATUSUNKNOWN) return false;
+  record = m_record;
+  record.flags = (status == DFR0534::PLAYING) ? JOURNALPLAYING : 0;
+  if (status == DFR0534::STOPPED) record.position = 0;
+  else {
+    word track = m_ptrAudio->getFileNumber();
+    if (track == 0) return false;
+    if (!m_valid || (track != m_record.track)) record.position = 0;
+    record.track = track;
+    if ((status == DFR0534::PLAYING) && (m_ptrAudio->getLastRuntimeMS() != 0) &&
+      (millis()-m_ptrAudio->getLastRuntimeMS() < JOURNALRUNTIMEAGEMS)) {
+      unsigned long position = m_ptrAudio->getLastRuntime();
+      record.position = (position > 0xffff) ? 0xffff : position;
+    }
+  }
+  record.drive = m_ptrAudio->getSelectedDrive();
+  record.volume = m_ptrAudio->getVolume();
+  record.equalizer = m_ptrAudio->getEqualizer();
+  record.loopMode = m_ptrAudio->getLoopMode();
+  return true;
+}
+
+/**@brief
+ * Checks whether a state differs from the newest record in more than the position
+ *
+ * @param[in] record  Playback state
+ *
+ * @retval true  State has changed
+ * @retval false Only the position differs or nothing
+ */
+bool DFR0534Journal::isChanged(RECORD &record)
+{
+  return (record.track != m_record.track) || (record.drive != m_record.drive) ||
+    (record.flags != m_record.flags) || (record.volume != m_record.volume) ||
+    (record.equalizer != m_record.equalizer) || (record.loopMode != m_record.loopMode);
+}
+
+/**@brief
+ * Find the newest valid record in the EEPROM
+ */
+void DFR0534Journal::load()
+{
+  RECORD record;
+  m_valid = false;
+  m_slot = m_slots-1; // First write goes to slot 0
+  for (byte slot=0;slot<m_slots;slot++) {
+    if (!readRecord(slot, record)) continue;
+    // Sequence numbers can overflow => compare the difference
+    word difference = record.sequence-m_record.sequence;
+    if (!m_valid || ((difference > 0) && (difference < 0x8000))) {
+      m_record = record;
+      m_slot = slot;
+      m_valid = true;
+    }
+  }
+  if (!m_valid) {
+    // Defaults after device startup
+    m_record.sequence = 0;
+    m_record.track = 0;
+    m_record.drive = DFR0534::DRIVEUNKNOWN;
+    m_record.flags = 0;
+    m_record.position = 0;
+    m_record.volume = 20;
+    m_record.equalizer = DFR0534::NORMAL;
+    m_record.loopMode = DFR0534::SINGLEAUDIOSTOP;
+  }
+  m_loaded = true;
+}
+
+/**@brief
+ * Read and check a record from the EEPROM
+ *
+ * @param[in]  slot    Slot number
+ * @param[out] record  Record
+ *
+ * @retval true  Valid record
+ * @retval false Checksum error
+ */
+bool DFR0534Journal::readRecord(byte slot, RECORD &record)
+{
+#if !DFR0534JOURNALEEPROM
+  (void)slot;
+  (void)record;
+  return false; // No storage
+#else
+  byte data[DFR0534JOURNALRECORDSIZE];
+  byte sum = 0;
+  int address = m_address+slot*DFR0534JOURNALRECORDSIZE;
+  for (byte i=0;i<DFR0534JOURNALRECORDSIZE;i++) {
+    data[i] = EEPROM.read(address+i);
+    if (i < DFR0534JOURNALRECORDSIZE-1) sum += data[i];
+  }
+  if ((byte)~sum != data[DFR0534JOURNALRECORDSIZE-1]) return false;
+  record.sequence = (data[0] << 8) | data[1];
+  record.track = (data[2] << 8) | data[3];
+  record.drive = data[4];
+  record.flags = data[5];
+  record.position = (data[6] << 8) | data[7];
+  record.volume = data[8];
+  record.equalizer = data[9];
+  record.loopMode = data[10];
+  return true;
+#endif
+}
+
+/**@brief
+ * Write a record with the next sequence number to the next slot
+ *
+ * @param[in,out] record  Record
+ */
+void DFR0534Journal::writeRecord(RECORD &record)
+{
+  byte data[DFR0534JOURNALRECORDSIZE];
+  record.sequence = m_valid ? m_record.sequence+1 : 1;
+  data[0] = record.sequence >> 8;
+  data[1] = record.sequence & 0xff;
+  data[2] = record.track >> 8;
+  data[3] = record.track & 0xff;
+  data[4] = record.drive;
+  data[5] = record.flags;
+  data[6] = record.position >> 8;
+  data[7] = record.position & 0xff;
+  data[8] = record.volume;
+  data[9] = record.equalizer;
+  data[10] = record.loopMode;
+  byte sum = 0;
+  for (byte i=0;i<DFR0534JOURNALRECORDSIZE-1;i++) sum += data[i];
+  data[DFR0534JOURNALRECORDSIZE-1] = ~sum;
+
+  byte slot = (m_slot+1) % m_slots;
+#if DFR0534JOURNALEEPROM
+  int address = m_address+slot*DFR0534JOURNALRECORDSIZE;
+  for (byte i=0;i<DFR0534JOURNALRECORDSIZE;i++) {
+    if (EEPROM.read(address+i) != data[i]) EEPROM.write(address+i, data[i]);
+  }
+  commit();
+#else
+  (void)data; // No storage
+#endif
+  m_slot = slot;
+  m_record = record;
+  m_valid = true;
+  m_writeCount++;
+}
@@ -0,0 +1,98 @@
+/**
+ * Class: DFR0534Journal
+ *
+ * Description:
+ * Wear leveled playback journal in EEPROM for resuming a DFR0534 audio module after a reset
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Journal.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+#ifndef DFR0534JOURNALEEPROM
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR) || defined(ESP32) || defined(ESP8266) || \
+  defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_RENESAS)
+/** 1 = Records are stored with the EEPROM library, 0 = Records are only kept in RAM (for boards without EEPROM.h, can be set by a build flag) */
+#define DFR0534JOURNALEEPROM 1
+#else
+#define DFR0534JOURNALEEPROM 0
+#endif
+#endif
+
+/** Default number of records in the EEPROM ring */
+#define DFR0534JOURNALSLOTS 16
+/** Bytes per record in the EEPROM */
+#define DFR0534JOURNALRECORDSIZE 12
+
+/**@brief
+ * Class for saving and restoring the playback state of a DFR0534 audio module
+ */
+class DFR0534Journal {
+  public:
+    /**@brief
+     * Constructor of a journal
+     *
+     * The journal needs slots*DFR0534JOURNALRECORDSIZE bytes of EEPROM starting at address
+     *
+     * @param[in] audio    DFR0534 audio module
+     * @param[in] address  First EEPROM address of the journal
+     * @param[in] slots    Number of records in the ring (more records = less writes per EEPROM cell)
+     */
+    DFR0534Journal(DFR0534 &audio, int address=0, byte slots=DFR0534JOURNALSLOTS)
+    {
+      m_ptrAudio = &audio;
+      m_address = address;
+      m_slots = (slots == 0) ? 1 : slots;
+    }
+    void clear();
+    word getRestoreFrames();
+    unsigned long getRestoreMS();
+    word getSequence();
+    word getWriteCount();
+    bool restore();
+    void save();
+    void setPositionStep(word seconds);
+    void tick();
+  private:
+    struct RECORD {
+      word sequence;
+      word track;
+      byte drive;
+      byte flags;
+      word position;
+      byte volume;
+      byte equalizer;
+      byte loopMode;
+    };
+    void commit();
+    bool getState(RECORD &record);
+    bool isChanged(RECORD &record);
+    void load();
+    bool readRecord(byte slot, RECORD &record);
+    void writeRecord(RECORD &record);
+    int m_address = 0;
+    byte m_slots = DFR0534JOURNALSLOTS;
+    bool m_loaded = false;
+    bool m_valid = false;
+    byte m_slot = 0;
+    RECORD m_record;
+    word m_positionStep = 30;
+    word m_writeCount = 0;
+    word m_restoreFrames = 0;
+    unsigned long m_restoreMS = 0;
+    unsigned long m_restoreStartMS = 0;
+    word m_seekPosition = 0;
+    unsigned long m_lastPollMS = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,315 @@
+/**
+ * Class: DFR0534LoopBank
+ *
+ * Description:
+ * Bank of A/B loop regions for DFR0534::repeatPart(), which switches between
+ * regions of the current file at the loop boundary
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - The file keeps playing when the region changes. Only repeatPart() or
+ *   stopRepeatPart() is sent, so there is no gap like with playFileByNumber()
+ * - select() and exit() take effect at the next loop boundary. tick() reads the
+ *   runtime, which the module sends every second, with DFR0534::pollRuntime().
+ *   When the runtime reaches the last second of the running region, the boundary
+ *   is expected one second later and the new region is sent LOOPBANKLEADMS before
+ * - When the boundary was missed (runtime wrapped back or reached the stop time),
+ *   the new region is sent immediately and counted by getLateCount()
+ * - While runtimes are sent by the module, replies for other requests take a
+ *   little longer, because runtime frames are skipped
+ * - Runtimes are enabled with DFR0534::startSendingRuntime(), when the first region starts.
+ *   When the bank leaves its last region (stop(), exit(), clear()), DFR0534::stopSendingRuntime()
+ *   is sent, unless runtimes were enabled before
+ * - play() does not send repeatPart() together with playFileByNumber(), because the module
+ *   ignores it while starting the file. tick() sends it with the first runtime of the new
+ *   file (or after LOOPBANKSTARTTIMEOUTMS)
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534LoopBank.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534LoopBank.h"
+
+// Time to send the repeatPart() frame before the expected boundary
+#define LOOPBANKLEADMS 20
+// Time between two runtimes
+#define LOOPBANKRUNTIMEMS 1000
+// Maximum wait for the first runtime after play()
+#define LOOPBANKSTARTTIMEOUTMS 1500
+
+/**@brief
+ * Add a loop region
+ *
+ * The first region gets the number 0, the second region 1...
+ *
+ * @param[in] startMinute  Start minute
+ * @param[in] startSecond  Start second
+ * @param[in] stopMinute   Stop minute
+ * @param[in] stopSecond   Stop second
+ *
+ * @retval true  Region added
+ * @retval false Invalid region or bank full
+ */
+bool DFR0534LoopBank::addRegion(byte startMinute, byte startSecond, byte stopMinute, byte stopSecond)
+{
+  if (m_regionCount >= DFR0534LOOPBANKSIZE) return false;
+  if ((startSecond > 59) || (stopSecond > 59)) return false;
+  word start = startMinute*60+startSecond;
+  word stop = stopMinute*60+stopSecond;
+  if (stop <= start) return false;
+  m_regions[m_regionCount].startSecond = start;
+  m_regions[m_regionCount].stopSecond = stop;
+  m_regionCount++;
+  return true;
+}
+
+/**@brief
+ * Remove all regions
+ *
+ * A running region is not stopped. A region waiting for the start of the file by play() is dropped.
+ */
+void DFR0534LoopBank::clear()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  m_regionCount = 0;
+  m_pending = false;
+  if (m_starting) finish();
+}
+
+/**@brief
+ * Leave the running region at the next loop boundary with DFR0534::stopRepeatPart()
+ *
+ * The file plays on after the region
+ */
+void DFR0534LoopBank::exit()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (m_current == DFR0534LOOPBANKNOREGION) return;
+  if (m_starting) {
+    // Region was not sent yet
+    finish();
+    return;
+  }
+  m_next = DFR0534LOOPBANKNOREGION;
+  m_pending = true;
+}
+
+/**@brief
+ * Get running region
+ *
+ * @returns Region number
+ * @retval DFR0534LOOPBANKNOREGION  No region is running
+ */
+byte DFR0534LoopBank::getRegion()
+{
+  return m_current;
+}
+
+/**@brief
+ * Get number of regions
+ *
+ * @returns Number of regions
+ */
+byte DFR0534LoopBank::getRegionCount()
+{
+  return m_regionCount;
+}
+
+/**@brief
+ * Get number of switches, which were sent after the boundary was missed
+ *
+ * @returns Number of late switches
+ */
+word DFR0534LoopBank::getLateCount()
+{
+  return m_lateCount;
+}
+
+/**@brief
+ * Get number of switches at loop boundaries
+ *
+ * @returns Number of switches
+ */
+word DFR0534LoopBank::getSwitchCount()
+{
+  return m_switchCount;
+}
+
+/**@brief
+ * Checks whether a switch or exit waits for the next loop boundary
+ *
+ * @retval true  Switch or start after play() is waiting
+ * @retval false No switch is waiting
+ */
+bool DFR0534LoopBank::isSwitching()
+{
+  return m_pending || m_starting;
+}
+
+/**@brief
+ * Play file and start looping a region
+ *
+ * The region is sent by tick(), when the module has started the file
+ *
+ * @param[in] track   File number
+ * @param[in] region  Region number
+ *
+ * @retval true  Playback started
+ * @retval false Invalid region
+ */
+bool DFR0534LoopBank::play(word track, byte region)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if (region >= m_regionCount) return false;
+  if (track <= 0) return false;
+  m_ptrAudio->playFileByNumber(track);
+  enableRuntime();
+  m_current = region;
+  m_pending = false;
+  m_boundaryKnown = false;
+  m_starting = true;
+  m_startMS = millis();
+  m_runtimeMS = m_ptrAudio->getLastRuntimeMS();
+  return true;
+}
+
+/**@brief
+ * Switch to another region at the next loop boundary
+ *
+ * When no region is running, the region starts immediately in the current file.
+ * A previous select() or exit(), which still waits for the boundary, is replaced.
+ *
+ * @param[in] region  Region number
+ *
+ * @retval true  Region selected
+ * @retval false Invalid region
+ */
+bool DFR0534LoopBank::select(byte region)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if (region >= m_regionCount) return false;
+  if (m_current == DFR0534LOOPBANKNOREGION) {
+    start(region);
+    return true;
+  }
+  if (m_starting) {
+    // Region was not sent yet
+    m_current = region;
+    return true;
+  }
+  m_next = region;
+  m_pending = (region != m_current);
+  return true;
+}
+
+/**@brief
+ * Leave the running region immediately with DFR0534::stopRepeatPart()
+ */
+void DFR0534LoopBank::stop()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (m_current == DFR0534LOOPBANKNOREGION) return;
+  if (!m_starting) m_ptrAudio->stopRepeatPart();
+  finish();
+}
+
+/**@brief
+ * Read runtimes and switch regions at the loop boundary
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534LoopBank::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  byte hour, minute, second;
+  m_ptrAudio->pollRuntime(hour, minute, second);
+  if (m_starting) {
+    // First runtime of the file started by play() => Module accepts repeatPart()
+    if ((m_ptrAudio->getLastRuntimeMS() != m_runtimeMS) || (millis()-m_startMS >= LOOPBANKSTARTTIMEOUTMS)) {
+      m_runtimeMS = m_ptrAudio->getLastRuntimeMS();
+      start(m_current);
+    }
+    return;
+  }
+  if (m_ptrAudio->getLastRuntimeMS() != m_runtimeMS) {
+    // New runtime received by this or another object
+    m_runtimeMS = m_ptrAudio->getLastRuntimeMS();
+    word position = m_ptrAudio->getLastRuntime();
+    if (m_pending && !m_boundaryKnown) {
+      word stop = m_regions[m_current].stopSecond;
+      if (position+1 == stop) {
+        m_boundaryMS = millis()+LOOPBANKRUNTIMEMS-LOOPBANKLEADMS;
+        m_boundaryKnown = true;
+      } else if ((position >= stop) || (position < m_position)) {
+        // Boundary missed
+        m_lateCount++;
+        switchRegion();
+      }
+    }
+    m_position = position;
+  }
+  if (m_pending && m_boundaryKnown && ((long)(millis()-m_boundaryMS) >= 0)) switchRegion();
+}
+
+/**@brief
+ * Enable runtimes and remember, whether they were enabled before the first region
+ */
+void DFR0534LoopBank::enableRuntime()
+{
+  if (m_current == DFR0534LOOPBANKNOREGION) m_wasSendingRuntime = m_ptrAudio->isSendingRuntime();
+  if (!m_ptrAudio->isSendingRuntime()) m_ptrAudio->startSendingRuntime();
+}
+
+/**@brief
+ * Leave the last region and restore the runtime sending state from before the first region
+ */
+void DFR0534LoopBank::finish()
+{
+  m_current = DFR0534LOOPBANKNOREGION;
+  m_pending = false;
+  m_starting = false;
+  m_boundaryKnown = false;
+  if (!m_wasSendingRuntime) m_ptrAudio->stopSendingRuntime();
+}
+
+/**@brief
+ * Start looping a region immediately
+ *
+ * @param[in] region  Region number
+ */
+void DFR0534LoopBank::start(byte region)
+{
+  enableRuntime();
+  m_ptrAudio->repeatPart(m_regions[region].startSecond/60, m_regions[region].startSecond%60,
+    m_regions[region].stopSecond/60, m_regions[region].stopSecond%60);
+  m_current = region;
+  m_pending = false;
+  m_starting = false;
+  m_boundaryKnown = false;
+  m_position = m_regions[region].startSecond;
+}
+
+/**@brief
+ * Send the selected region or leave the running region
+ */
+void DFR0534LoopBank::switchRegion()
+{
+  if (m_next == DFR0534LOOPBANKNOREGION) {
+    m_ptrAudio->stopRepeatPart();
+    finish();
+  } else {
+    m_ptrAudio->repeatPart(m_regions[m_next].startSecond/60, m_regions[m_next].startSecond%60,
+      m_regions[m_next].stopSecond/60, m_regions[m_next].stopSecond%60);
+    m_current = m_next;
+    m_position = m_regions[m_next].startSecond;
+  }
+  m_pending = false;
+  m_boundaryKnown = false;
+  m_switchCount++;
+}
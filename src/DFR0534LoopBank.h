@@ -0,0 +1,79 @@
+/**
+ * Class: DFR0534LoopBank
+ *
+ * Description:
+ * Bank of A/B loop regions for DFR0534::repeatPart(), which switches between
+ * regions of the current file at the loop boundary
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534LoopBank.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/** Maximum number of loop regions */
+#define DFR0534LOOPBANKSIZE 8
+/** No loop region */
+#define DFR0534LOOPBANKNOREGION 0xff
+
+/**@brief
+ * Class for switching between loop regions of a file on a DFR0534 audio module
+ */
+class DFR0534LoopBank {
+  public:
+    /**@brief
+     * Constructor of a loop bank
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534LoopBank(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+    }
+    bool addRegion(byte startMinute, byte startSecond, byte stopMinute, byte stopSecond);
+    void clear();
+    void exit();
+    byte getRegion();
+    byte getRegionCount();
+    word getLateCount();
+    word getSwitchCount();
+    bool isSwitching();
+    bool play(word track, byte region);
+    bool select(byte region);
+    void stop();
+    void tick();
+  private:
+    struct REGION {
+      word startSecond;
+      word stopSecond;
+    };
+    void enableRuntime();
+    void finish();
+    void start(byte region);
+    void switchRegion();
+    REGION m_regions[DFR0534LOOPBANKSIZE];
+    byte m_regionCount = 0;
+    byte m_current = DFR0534LOOPBANKNOREGION;
+    byte m_next = DFR0534LOOPBANKNOREGION;
+    bool m_pending = false;
+    bool m_starting = false;
+    unsigned long m_startMS = 0;
+    bool m_wasSendingRuntime = false;
+    bool m_boundaryKnown = false;
+    unsigned long m_boundaryMS = 0;
+    word m_position = 0;
+    unsigned long m_runtimeMS = 0;
+    word m_switchCount = 0;
+    word m_lateCount = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,206 @@
+/**
+ * Class: DFR0534MetaCache
+ *
+ * Description:
+ * Background cache for file names and durations of a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - tick() requests DFR0534::getFileNumber() every METACACHEPOLLMS. When the file has
+ *   changed and is not in the cache, the next ticks request DFR0534::getFileName() and
+ *   DFR0534::getDuration(). tick() sends at most one request and only, when no other
+ *   frame was sent for METACACHEIDLEMS
+ * - Name and duration are used, when the next DFR0534::getFileNumber() still returns
+ *   the same file, because the module answers these requests for the current file
+ * - Entries are keyed by file number and drive. When the cache is full, the least recently
+ *   used entry is replaced. A file played again is never requested again
+ * - Call clear(), when the content of a drive has changed
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534MetaCache.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534MetaCache.h"
+
+// Interval for checking the current file
+#define METACACHEPOLLMS 250
+// Minimum time without other frames before a request
+#define METACACHEIDLEMS 100
+// Entry states
+#define METAEMPTY 0
+#define METANEEDNAME 1
+#define METANEEDDURATION 2
+#define METANEEDCONFIRM 3
+#define METAREADY 4
+
+/**@brief
+ * Remove all entries
+ */
+void DFR0534MetaCache::clear()
+{
+  for (byte i=0;i<DFR0534METACACHESIZE;i++) {
+    m_entries[i].state = METAEMPTY;
+    m_entries[i].age = 0;
+  }
+  m_current = NULL;
+  m_fileNumber = 0;
+}
+
+/**@brief
+ * Get duration of the current file without serial communication
+ *
+ * @param[out] hour   Hours
+ * @param[out] minute Minutes
+ * @param[out] second Seconds
+ *
+ * @retval true  Duration is known
+ * @retval false Duration not yet known
+ */
+bool DFR0534MetaCache::getDuration(byte &hour, byte &minute, byte &second)
+{
+  if (!isReady()) return false;
+  hour = m_current->hour;
+  minute = m_current->minute;
+  second = m_current->second;
+  return true;
+}
+
+/**@brief
+ * Get file name of the current file without serial communication
+ *
+ * @param[out] name  File name like DFR0534::getFileName() (buffer has to be at least 12 bytes)
+ *
+ * @retval true  Name is known
+ * @retval false Name not yet known
+ */
+bool DFR0534MetaCache::getFileName(char *name)
+{
+  if (name == NULL) return false;
+  if (!isReady()) return false;
+  strcpy(name, m_current->name);
+  return true;
+}
+
+/**@brief
+ * Get file number of the current file at the last check without serial communication
+ *
+ * @returns File number (0 = unknown)
+ */
+word DFR0534MetaCache::getFileNumber()
+{
+  return m_fileNumber;
+}
+
+/**@brief
+ * Get number of file changes, which were served from the cache without requests
+ *
+ * @returns Number of cache hits
+ */
+word DFR0534MetaCache::getHitCount()
+{
+  return m_hitCount;
+}
+
+/**@brief
+ * Get number of requests sent by the cache
+ *
+ * @returns Number of requests
+ */
+word DFR0534MetaCache::getQueryCount()
+{
+  return m_queryCount;
+}
+
+/**@brief
+ * Checks whether name and duration of the current file are known
+ *
+ * @retval true  Name and duration are known
+ * @retval false Not yet known
+ */
+bool DFR0534MetaCache::isReady()
+{
+  return (m_current != NULL) && (m_current->state == METAREADY);
+}
+
+/**@brief
+ * Detect file changes and request name and duration in the background
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534MetaCache::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  unsigned long nowMS = millis();
+  if (nowMS-m_ptrAudio->getLastSendMS() < METACACHEIDLEMS) return; // Serial connection in use
+
+  if ((m_current != NULL) && (m_current->state == METANEEDNAME)) {
+    m_queryCount++;
+    if (m_ptrAudio->getFileName(m_current->name)) m_current->state = METANEEDDURATION;
+    return;
+  }
+  if ((m_current != NULL) && (m_current->state == METANEEDDURATION)) {
+    m_queryCount++;
+    if (m_ptrAudio->getDuration(m_current->hour, m_current->minute, m_current->second)) m_current->state = METANEEDCONFIRM;
+    return;
+  }
+
+  if (m_polled && (nowMS-m_lastPollMS < METACACHEPOLLMS)) return;
+  m_lastPollMS = nowMS;
+  m_polled = true;
+  m_queryCount++;
+  word fileNumber = m_ptrAudio->getFileNumber();
+  if (fileNumber == 0) return; // Request failed or no file
+  byte drive = m_ptrAudio->getSelectedDrive();
+
+  if ((m_current != NULL) && (m_current->fileNumber == fileNumber) && (m_current->drive == drive)) {
+    if (m_current->state == METANEEDCONFIRM) m_current->state = METAREADY;
+    return;
+  }
+
+  // File has changed => data of an unconfirmed entry can belong to the new file
+  if ((m_current != NULL) && (m_current->state != METAREADY)) m_current->state = METAEMPTY;
+  m_fileNumber = fileNumber;
+
+  ENTRY *entry = find(fileNumber, drive);
+  if (entry != NULL) m_hitCount++;
+  else {
+    // Replace empty or least recently used entry
+    entry = &m_entries[0];
+    for (byte i=0;i<DFR0534METACACHESIZE;i++) {
+      if (m_entries[i].state == METAEMPTY) {
+        entry = &m_entries[i];
+        break;
+      }
+      if (m_entries[i].age > entry->age) entry = &m_entries[i];
+    }
+    entry->fileNumber = fileNumber;
+    entry->drive = drive;
+    entry->state = METANEEDNAME;
+  }
+  for (byte i=0;i<DFR0534METACACHESIZE;i++) if (m_entries[i].age < 0xff) m_entries[i].age++;
+  entry->age = 0;
+  m_current = entry;
+}
+
+/**@brief
+ * Find entry for a file
+ *
+ * @param[in] fileNumber  File number
+ * @param[in] drive       Drive of the file
+ *
+ * @returns Entry or NULL, when the file is not in the cache
+ */
+DFR0534MetaCache::ENTRY *DFR0534MetaCache::find(word fileNumber, byte drive)
+{
+  for (byte i=0;i<DFR0534METACACHESIZE;i++) {
+    if ((m_entries[i].state == METAREADY) && (m_entries[i].fileNumber == fileNumber) &&
+      (m_entries[i].drive == drive)) return &m_entries[i];
+  }
+  return NULL;
+}
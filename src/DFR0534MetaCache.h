@@ -0,0 +1,69 @@
+/**
+ * Class: DFR0534MetaCache
+ *
+ * Description:
+ * Background cache for file names and durations of a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534MetaCache.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/** Number of files in the cache */
+#define DFR0534METACACHESIZE 4
+
+/**@brief
+ * Class for prefetching file name and duration of the current file on a DFR0534 audio module
+ */
+class DFR0534MetaCache {
+  public:
+    /**@brief
+     * Constructor of a metadata cache
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534MetaCache(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+      clear();
+    }
+    void clear();
+    bool getDuration(byte &hour, byte &minute, byte &second);
+    bool getFileName(char *name);
+    word getFileNumber();
+    word getHitCount();
+    word getQueryCount();
+    bool isReady();
+    void tick();
+  private:
+    struct ENTRY {
+      word fileNumber;
+      byte drive;
+      byte state;
+      byte hour;
+      byte minute;
+      byte second;
+      byte age;
+      char name[12];
+    };
+    ENTRY *find(word fileNumber, byte drive);
+    ENTRY m_entries[DFR0534METACACHESIZE];
+    ENTRY *m_current = NULL;
+    word m_fileNumber = 0;
+    word m_hitCount = 0;
+    word m_queryCount = 0;
+    unsigned long m_lastPollMS = 0;
+    bool m_polled = false;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,190 @@
+/**
+ * Class: DFR0534Phrase
+ *
+ * Description:
+ * Compile time checked phrases for DFR0534::playCombined()
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - A phrase is a fixed list of two char files in the directory /ZH.
+ *   DFR0534PhraseChars takes the chars of the file names,
+ *   for example DFR0534PhraseChars<'2','1', 'A','X'> plays /ZH/21.wav and /ZH/AX.wav
+ * - An odd number of chars, chars other than 0-9 and A-Z, empty phrases and phrases
+ *   with more than DFR0534PHRASEMAXCLIPS files are rejected by the compiler
+ * - DFR0534Phrase is a short form for file names with hex digits. Each file is
+ *   given as a number, whose hex notation is the file name, for example
+ *   DFR0534Phrase<0x21, 0x0A> plays /ZH/21.wav and /ZH/0A.wav. Numbers above 0xFF are rejected
+ * - The list is encoded at compile time and stored in flash memory
+ *
+ * Example:
+ *   typedef DFR0534Phrase<0x05, 0x04, 0x03> Countdown;
+ *   Countdown::play(g_audio);
+ *   DFR0534PhraseChars<'H','I', 'G','O'>::play(g_audio);
+ *
+ *   // Table of phrases
+ *   const __FlashStringHelper *g_phrases[] = { DFR0534Phrase<0x01>::get(), DFR0534Phrase<0x10, 0x0A>::get() };
+ *   g_audio.playCombined(g_phrases[1]);
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Phrase.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/** Maximum number of files in a phrase (playCombined() accepts up to 254 chars) */
+#define DFR0534PHRASEMAXCLIPS 127
+
+/** Two chars of a file name in a phrase */
+struct DFR0534PHRASECLIP {
+  char high; /**< First char */
+  char low; /**< Second char */
+};
+
+/**@brief
+ * Upper case hex char for a nibble
+ *
+ * @param[in] nibble  Value 0-15
+ *
+ * @returns Char '0'-'9' or 'A'-'F'
+ */
+constexpr char DFR0534PhraseHexChar(unsigned int nibble)
+{
+  return (nibble < 10) ? '0'+nibble : 'A'+nibble-10;
+}
+
+/**@brief
+ * End of recursion for DFR0534PhraseValid()
+ *
+ * @retval true
+ */
+constexpr bool DFR0534PhraseValid()
+{
+  return true;
+}
+
+/**@brief
+ * Checks whether all file numbers are two char hex names
+ *
+ * @param[in] clip   First file number
+ * @param[in] clips  Other file numbers
+ *
+ * @retval true  All file numbers are between 0x00 and 0xFF
+ * @retval false Invalid file number
+ */
+template<typename... T>
+constexpr bool DFR0534PhraseValid(unsigned int clip, T... clips)
+{
+  return (clip <= 0xFF) && DFR0534PhraseValid(clips...);
+}
+
+/**@brief
+ * End of recursion for DFR0534PhraseValidChars()
+ *
+ * @retval true
+ */
+constexpr bool DFR0534PhraseValidChars()
+{
+  return true;
+}
+
+/**@brief
+ * Checks whether all chars are valid in file names of a phrase
+ *
+ * @param[in] c      First char
+ * @param[in] chars  Other chars
+ *
+ * @retval true  All chars are 0-9 or A-Z
+ * @retval false Invalid char
+ */
+template<typename... T>
+constexpr bool DFR0534PhraseValidChars(char c, T... chars)
+{
+  return (((c >= '0') && (c <= '9')) || ((c >= 'A') && (c <= 'Z'))) && DFR0534PhraseValidChars(chars...);
+}
+
+/**@brief
+ * Class for a phrase of two char files in the directory /ZH given by the chars of the file names, which is checked at compile time
+ */
+template<char... chars>
+class DFR0534PhraseChars {
+  static_assert(sizeof...(chars) > 0, "DFR0534PhraseChars needs at least one file");
+  static_assert(sizeof...(chars) % 2 == 0, "DFR0534PhraseChars needs two chars per file");
+  static_assert(sizeof...(chars) <= 2*DFR0534PHRASEMAXCLIPS, "DFR0534PhraseChars has too many files");
+  static_assert(DFR0534PhraseValidChars(chars...), "DFR0534PhraseChars chars must be 0-9 or A-Z");
+  public:
+    /** Number of chars in the list */
+    static const byte length = sizeof...(chars);
+    /**@brief
+     * Get list in flash memory
+     *
+     * @returns List for DFR0534::playCombined()
+     */
+    static const __FlashStringHelper *get()
+    {
+      return reinterpret_cast<const __FlashStringHelper *>(m_list);
+    }
+    /**@brief
+     * Play phrase
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    static void play(DFR0534 &audio)
+    {
+      audio.playCombined(get());
+    }
+  private:
+    static const char m_list[sizeof...(chars)+1];
+};
+
+/** List: The chars and a terminating '\0' */
+template<char... chars>
+const char DFR0534PhraseChars<chars...>::m_list[sizeof...(chars)+1] PROGMEM = { chars..., '\0' };
+
+/**@brief
+ * Class for a phrase of two char files in the directory /ZH with hex digit names, which is checked and encoded at compile time
+ */
+template<unsigned int... clips>
+class DFR0534Phrase {
+  static_assert(sizeof...(clips) > 0, "DFR0534Phrase needs at least one file");
+  static_assert(sizeof...(clips) <= DFR0534PHRASEMAXCLIPS, "DFR0534Phrase has too many files");
+  static_assert(DFR0534PhraseValid(clips...), "DFR0534Phrase files must be between 0x00 and 0xFF");
+  static_assert(sizeof(DFR0534PHRASECLIP) == 2, "DFR0534PHRASECLIP must not be padded");
+  public:
+    /** Number of chars in the encoded list */
+    static const byte length = 2*sizeof...(clips);
+    /**@brief
+     * Get encoded list in flash memory
+     *
+     * @returns List for DFR0534::playCombined()
+     */
+    static const __FlashStringHelper *get()
+    {
+      return reinterpret_cast<const __FlashStringHelper *>(m_list);
+    }
+    /**@brief
+     * Play phrase
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    static void play(DFR0534 &audio)
+    {
+      audio.playCombined(get());
+    }
+  private:
+    static const DFR0534PHRASECLIP m_list[sizeof...(clips)+1];
+};
+
+/** Encoded list: Two hex chars per file and a terminating '\0' */
+template<unsigned int... clips>
+const DFR0534PHRASECLIP DFR0534Phrase<clips...>::m_list[sizeof...(clips)+1] PROGMEM = {
+  { DFR0534PhraseHexChar(clips >> 4), DFR0534PhraseHexChar(clips & 0x0F) }..., { '\0', '\0' }
+};
@@ -0,0 +1,219 @@
+/**
+ * Class: DFR0534Scheduler
+ *
+ * Description:
+ * Transmit scheduler with priority classes and a byte budget for background
+ * requests to a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - At 9600 baud a byte needs about 1ms. tick() runs at most one job and the jobs
+ *   send their frames with the normal DFR0534 functions, so a started frame and its
+ *   answer are never interrupted. A job with a higher priority waits at most for
+ *   the running job
+ * - Waiting jobs are sorted by priority (FIFO per priority). Interactive commands
+ *   run before queries and queries before background jobs
+ * - Background jobs and pollers (for example the tick() of DFR0534MetaCache or
+ *   DFR0534History) only run, when no other job is waiting, the connection was idle
+ *   for SCHEDULERGAPMS and the byte budget is not exhausted. The budget is refilled
+ *   with the bytes per second set by setBackgroundBudget() and the bytes really sent
+ *   by a background job (DFR0534::getSentBytes()) are charged afterwards
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Scheduler.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Scheduler.h"
+
+// Minimum time after the last frame before background jobs
+#define SCHEDULERGAPMS 20
+// Maximum time for refilling the byte budget (= maximum burst)
+#define SCHEDULERBURSTMS 1000
+
+/**@brief
+ * Add a function, which is called as background job, when the budget allows it
+ *
+ * Pollers are called round robin. A poller should send at most a few frames,
+ * like the tick() of the helper classes.
+ *
+ * @param[in] poller   Function, which gets the context as parameter
+ * @param[in] context  Pointer passed to the function, for example a helper object (optional)
+ *
+ * @retval true  Poller added
+ * @retval false Invalid function or DFR0534SCHEDULERPOLLERS reached
+ */
+bool DFR0534Scheduler::addPoller(void (*poller)(void *context), void *context)
+{
+  if (poller == NULL) return false;
+  if (m_pollerCount >= DFR0534SCHEDULERPOLLERS) return false;
+  m_pollers[m_pollerCount] = poller;
+  m_pollerContexts[m_pollerCount] = context;
+  m_pollerCount++;
+  return true;
+}
+
+/**@brief
+ * Remove all waiting jobs and reset the statistics
+ */
+void DFR0534Scheduler::clear()
+{
+  m_queueCount = 0;
+  m_backgroundBytes = 0;
+  for (byte i=0;i<PRIORITYUNKNOWN;i++) {
+    m_maxWaitMS[i] = 0;
+    m_sumWaitMS[i] = 0;
+    m_startedCount[i] = 0;
+  }
+}
+
+/**@brief
+ * Get number of bytes sent by background jobs and pollers
+ *
+ * @returns Number of bytes
+ */
+unsigned long DFR0534Scheduler::getBackgroundBytes()
+{
+  return m_backgroundBytes;
+}
+
+/**@brief
+ * Get maximum queue wait time of a priority class
+ *
+ * @param[in] priority  Priority class like DFR0534Scheduler::PRIORITYQUERY
+ *
+ * @returns Wait time in ms
+ */
+unsigned long DFR0534Scheduler::getMaxWaitMS(byte priority)
+{
+  if (priority >= PRIORITYUNKNOWN) return 0;
+  return m_maxWaitMS[priority];
+}
+
+/**@brief
+ * Get mean queue wait time of a priority class
+ *
+ * @param[in] priority  Priority class like DFR0534Scheduler::PRIORITYQUERY
+ *
+ * @returns Wait time in ms
+ */
+unsigned long DFR0534Scheduler::getMeanWaitMS(byte priority)
+{
+  if (priority >= PRIORITYUNKNOWN) return 0;
+  if (m_startedCount[priority] == 0) return 0;
+  return m_sumWaitMS[priority]/m_startedCount[priority];
+}
+
+/**@brief
+ * Get number of waiting jobs
+ *
+ * @returns Number of waiting jobs
+ */
+byte DFR0534Scheduler::getQueueCount()
+{
+  return m_queueCount;
+}
+
+/**@brief
+ * Set byte budget for background jobs and pollers
+ *
+ * @param[in] bytesPerSecond  Bytes per second (default 96 = about 10% of 9600 baud, 0 = no background jobs)
+ */
+void DFR0534Scheduler::setBackgroundBudget(word bytesPerSecond)
+{
+  m_budget = bytesPerSecond;
+  if (m_credit > (long)m_budget*1000) m_credit = (long)m_budget*1000;
+}
+
+/**@brief
+ * Add a job
+ *
+ * The job is called by tick() and can use all DFR0534 functions.
+ *
+ * @param[in] job       Function, which gets the context as parameter
+ * @param[in] priority  Priority class: DFR0534Scheduler::PRIORITYINTERACTIVE, DFR0534Scheduler::PRIORITYQUERY or DFR0534Scheduler::PRIORITYBACKGROUND
+ * @param[in] context   Pointer passed to the function, for example a file number or a helper object (optional)
+ *
+ * @retval true  Job queued
+ * @retval false Invalid parameter or queue full
+ */
+bool DFR0534Scheduler::submit(void (*job)(void *context), byte priority, void *context)
+{
+  if (job == NULL) return false;
+  if (priority >= PRIORITYUNKNOWN) return false;
+  if (m_queueCount >= DFR0534SCHEDULERQUEUESIZE) return false;
+
+  // Insert behind all jobs with the same or a higher priority (FIFO per priority)
+  byte position = m_queueCount;
+  while ((position > 0) && (m_queue[position-1].priority < priority)) {
+    m_queue[position] = m_queue[position-1];
+    position--;
+  }
+  m_queue[position].job = job;
+  m_queue[position].context = context;
+  m_queue[position].priority = priority;
+  m_queue[position].queuedMS = millis();
+  m_queueCount++;
+  return true;
+}
+
+/**@brief
+ * Run the next job or poller
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Scheduler::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  unsigned long nowMS = millis();
+
+  // Refill budget (in 1/1000 bytes)
+  unsigned long elapsedMS = nowMS-m_lastRefillMS;
+  if (elapsedMS > SCHEDULERBURSTMS) elapsedMS = SCHEDULERBURSTMS;
+  m_lastRefillMS = nowMS;
+  m_credit += (long)elapsedMS*m_budget;
+  if (m_credit > (long)m_budget*1000) m_credit = (long)m_budget*1000;
+
+  if (m_queueCount > 0) {
+    JOB job = m_queue[0];
+    if (job.priority == PRIORITYBACKGROUND) {
+      if ((m_credit <= 0) || (nowMS-m_ptrAudio->getLastSendMS() < SCHEDULERGAPMS)) return;
+    }
+    m_queueCount--;
+    for (byte i=0;i<m_queueCount;i++) m_queue[i] = m_queue[i+1];
+
+    unsigned long waitMS = nowMS-job.queuedMS;
+    if (waitMS > m_maxWaitMS[job.priority]) m_maxWaitMS[job.priority] = waitMS;
+    m_sumWaitMS[job.priority] += waitMS;
+    m_startedCount[job.priority]++;
+
+    if (job.priority == PRIORITYBACKGROUND) runBackground(job.job, job.context); else job.job(job.context);
+    return;
+  }
+
+  if (m_pollerCount == 0) return;
+  if ((m_credit <= 0) || (nowMS-m_ptrAudio->getLastSendMS() < SCHEDULERGAPMS)) return;
+  if (m_nextPoller >= m_pollerCount) m_nextPoller = 0;
+  runBackground(m_pollers[m_nextPoller], m_pollerContexts[m_nextPoller]);
+  m_nextPoller++;
+}
+
+/**@brief
+ * Run a background job and charge the sent bytes to the budget
+ *
+ * @param[in] job      Function
+ * @param[in] context  Pointer passed to the function
+ */
+void DFR0534Scheduler::runBackground(void (*job)(void *context), void *context)
+{
+  unsigned long startBytes = m_ptrAudio->getSentBytes();
+  job(context);
+  unsigned long bytes = m_ptrAudio->getSentBytes()-startBytes;
+  m_backgroundBytes += bytes;
+  m_credit -= (long)bytes*1000;
+}
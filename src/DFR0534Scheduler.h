@@ -0,0 +1,83 @@
+/**
+ * Class: DFR0534Scheduler
+ *
+ * Description:
+ * Transmit scheduler with priority classes and a byte budget for background
+ * requests to a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Scheduler.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/** Maximum number of waiting jobs */
+#define DFR0534SCHEDULERQUEUESIZE 8
+/** Maximum number of background pollers */
+#define DFR0534SCHEDULERPOLLERS 4
+
+/**@brief
+ * Class for sharing the serial connection to a DFR0534 audio module between commands, queries and background polling
+ */
+class DFR0534Scheduler {
+  public:
+    /** Priority classes */
+    enum DFR0534PRIORITY
+    {
+      PRIORITYBACKGROUND, /**< Background polling */
+      PRIORITYQUERY, /**< Request needed by the user interface */
+      PRIORITYINTERACTIVE, /**< Command of the user (=highest priority) */
+      PRIORITYUNKNOWN /**< Unknown */
+    };
+    /**@brief
+     * Constructor of a transmit scheduler
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534Scheduler(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+      clear();
+    }
+    bool addPoller(void (*poller)(void *context), void *context=NULL);
+    void clear();
+    unsigned long getBackgroundBytes();
+    unsigned long getMaxWaitMS(byte priority);
+    unsigned long getMeanWaitMS(byte priority);
+    byte getQueueCount();
+    void setBackgroundBudget(word bytesPerSecond);
+    bool submit(void (*job)(void *context), byte priority, void *context=NULL);
+    void tick();
+  private:
+    struct JOB {
+      void (*job)(void *context);
+      void *context;
+      byte priority;
+      unsigned long queuedMS;
+    };
+    void runBackground(void (*job)(void *context), void *context);
+    JOB m_queue[DFR0534SCHEDULERQUEUESIZE];
+    byte m_queueCount = 0;
+    void (*m_pollers[DFR0534SCHEDULERPOLLERS])(void *context);
+    void *m_pollerContexts[DFR0534SCHEDULERPOLLERS];
+    byte m_pollerCount = 0;
+    byte m_nextPoller = 0;
+    word m_budget = 96;
+    long m_credit = 0;
+    unsigned long m_lastRefillMS = 0;
+    unsigned long m_backgroundBytes = 0;
+    unsigned long m_maxWaitMS[PRIORITYUNKNOWN];
+    unsigned long m_sumWaitMS[PRIORITYUNKNOWN];
+    word m_startedCount[PRIORITYUNKNOWN];
+    DFR0534 *m_ptrAudio = NULL;
+};
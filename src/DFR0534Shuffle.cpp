@@ -0,0 +1,277 @@
+/**
+ * Class: DFR0534Shuffle
+ *
+ * Description:
+ * Seeded shuffle without repeats for all files on a drive or in a directory
+ * of a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - The order is not stored. getFileNumber() computes the file for an index with a
+ *   4 round Feistel network over the smallest even bit width, which covers all files.
+ *   Results outside the file range are encrypted again (cycle walking), so every index
+ *   maps to a different file and a cycle has no repeats. RAM usage does not depend on
+ *   the number of files
+ * - The order only depends on seed and file count and is the same on all platforms.
+ *   Save getSeed() and getIndex() to continue later with resume()
+ * - After a cycle the seed is advanced for the next cycle. The first file of the next
+ *   cycle is never the last file of the previous cycle: When the order of the new seed
+ *   starts with the last file of the previous seed, the first two files are swapped.
+ *   The previous seed is computed from the seed, so resume() needs no further state.
+ *   With two files the seed is not advanced and every cycle has the same order
+ * - Files are started with DFR0534::prepareFileByNumber() and DFR0534::play()
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Shuffle.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Shuffle.h"
+
+// Interval for checking whether the file has finished
+#define SHUFFLEPOLLMS 250
+// Time the audio module needs to start a file
+#define SHUFFLESTARTUPMS 500
+// Number of Feistel rounds
+#define SHUFFLEROUNDS 4
+// Linear congruential generator for the seed of the next cycle
+#define SHUFFLESEEDMULTIPLIER 1664525UL
+#define SHUFFLESEEDINCREMENT 1013904223UL
+// Multiplicative inverse of SHUFFLESEEDMULTIPLIER (mod 2^32) for the seed of the previous cycle
+#define SHUFFLESEEDINVERSE 0xFEE058C5UL
+
+/**@brief
+ * Start a new shuffle
+ *
+ * Reads the file range from the audio module. Does not start playback.
+ *
+ * @param[in] seed       Seed for the order (same seed = same order)
+ * @param[in] directory  true = Files in the current directory, false = All files on the drive (=default)
+ *
+ * @retval true  Shuffle ready
+ * @retval false No files or request failed
+ */
+bool DFR0534Shuffle::begin(unsigned long seed, bool directory)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  m_playing = false;
+  m_total = 0;
+  int first = 1;
+  int total;
+  if (directory) {
+    first = m_ptrAudio->getFirstFileNumberInCurrentDirectory();
+    if (first <= 0) return false;
+    total = m_ptrAudio->getTotalFilesInCurrentDirectory();
+  } else total = m_ptrAudio->getTotalFiles();
+  if (total <= 0) return false;
+
+  m_first = first;
+  m_total = total;
+  m_index = 0;
+  m_seed = seed & 0xffffffffUL;
+  byte bits = 1;
+  while (bits < 16 && (1UL << bits) < m_total) bits++;
+  m_halfBits = (bits+1)/2;
+  updateBoundary();
+  return true;
+}
+
+/**@brief
+ * Get file for a position in the current cycle
+ *
+ * @param[in] index  Position in the cycle (0 to getTotal()-1)
+ *
+ * @returns File number (0 = invalid position)
+ */
+word DFR0534Shuffle::getFileNumber(word index)
+{
+  if (index >= m_total) return 0;
+  if (m_swapFirst && (index < 2)) index ^= 1;
+  return m_first + permute(index);
+}
+
+/**@brief
+ * Get position of the current file in the current cycle
+ *
+ * @returns Position (0 to getTotal()-1)
+ */
+word DFR0534Shuffle::getIndex()
+{
+  return m_index;
+}
+
+/**@brief
+ * Get seed of the current cycle
+ *
+ * @returns Seed for resume()
+ */
+unsigned long DFR0534Shuffle::getSeed()
+{
+  return m_seed;
+}
+
+/**@brief
+ * Get number of files in the shuffle
+ *
+ * @returns Number of files (0 = begin() was not successful)
+ */
+word DFR0534Shuffle::getTotal()
+{
+  return m_total;
+}
+
+/**@brief
+ * Play the next file
+ *
+ * Starts a new cycle after the last file
+ *
+ * @retval true  File started
+ * @retval false No files
+ */
+bool DFR0534Shuffle::next()
+{
+  if (m_total == 0) return false;
+  m_index++;
+  if (m_index >= m_total) nextCycle();
+  return play();
+}
+
+/**@brief
+ * Play the current file and continue with the next files after it has finished
+ *
+ * @retval true  File started
+ * @retval false No files
+ */
+bool DFR0534Shuffle::play()
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if (m_total == 0) return false;
+  m_ptrAudio->prepareFileByNumber(getFileNumber(m_index));
+  m_ptrAudio->play();
+  m_playing = true;
+  m_playMS = millis();
+  m_lastPollMS = m_playMS;
+  return true;
+}
+
+/**@brief
+ * Continue a saved shuffle
+ *
+ * Does not start playback. Call play() to play the file at the saved position.
+ *
+ * @param[in] seed       Seed from getSeed()
+ * @param[in] index      Position from getIndex()
+ * @param[in] directory  true = Files in the current directory, false = All files on the drive (=default)
+ *
+ * @retval true  Shuffle ready
+ * @retval false No files, request failed or position out of range
+ */
+bool DFR0534Shuffle::resume(unsigned long seed, word index, bool directory)
+{
+  if (!begin(seed, directory)) return false;
+  if (index >= m_total) return false;
+  m_index = index;
+  return true;
+}
+
+/**@brief
+ * Stop playback
+ */
+void DFR0534Shuffle::stop()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  m_playing = false;
+  m_ptrAudio->stop();
+}
+
+/**@brief
+ * Play the next file, when the current file has finished
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Shuffle::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (!m_playing) return;
+
+  unsigned long nowMS = millis();
+  if (nowMS-m_playMS < SHUFFLESTARTUPMS) return;
+  if (nowMS-m_lastPollMS < SHUFFLEPOLLMS) return;
+  m_lastPollMS = nowMS;
+  if (m_ptrAudio->getStatus() != DFR0534::STOPPED) return; // Still playing or try again later
+  next();
+}
+
+/**@brief
+ * Round function of the Feistel network
+ *
+ * @param[in] value   Half block
+ * @param[in] number  Round number
+ *
+ * @returns Mixed 32 bit value
+ */
+unsigned long DFR0534Shuffle::mix(unsigned long value, byte number)
+{
+  unsigned long result = (value ^ m_seed ^ (number * 0x9E3779B9UL)) & 0xffffffffUL;
+  result ^= result >> 16;
+  result = (result * 0x7FEB352DUL) & 0xffffffffUL;
+  result ^= result >> 15;
+  result = (result * 0x846CA68BUL) & 0xffffffffUL;
+  result ^= result >> 16;
+  return result;
+}
+
+/**@brief
+ * Start next cycle with a new seed
+ */
+void DFR0534Shuffle::nextCycle()
+{
+  if (m_total > 2) m_seed = (m_seed * SHUFFLESEEDMULTIPLIER + SHUFFLESEEDINCREMENT) & 0xffffffffUL;
+  updateBoundary();
+  m_index = 0;
+}
+
+/**@brief
+ * Map a position to a file offset
+ *
+ * @param[in] index  Position in the cycle (has to be less than m_total)
+ *
+ * @returns File offset from the first file (0 to m_total-1)
+ */
+word DFR0534Shuffle::permute(word index)
+{
+  unsigned long mask = (1UL << m_halfBits) - 1;
+  unsigned long value = index;
+  do {
+    unsigned long left = value >> m_halfBits;
+    unsigned long right = value & mask;
+    for (byte i=0;i<SHUFFLEROUNDS;i++) {
+      unsigned long temp = left ^ (mix(right, i) & mask);
+      left = right;
+      right = temp;
+    }
+    value = (left << m_halfBits) | right;
+  } while (value >= m_total); // Cycle walking
+  return value;
+}
+
+/**@brief
+ * Swap the first two files, when the cycle would start with the last file of the previous cycle
+ *
+ * The previous cycle only swaps its first two files, so its last file does not depend on its own swap
+ */
+void DFR0534Shuffle::updateBoundary()
+{
+  m_swapFirst = false;
+  if (m_total < 3) return;
+  unsigned long seed = m_seed;
+  m_seed = ((seed - SHUFFLESEEDINCREMENT) * SHUFFLESEEDINVERSE) & 0xffffffffUL;
+  word previousLast = permute(m_total-1);
+  m_seed = seed;
+  m_swapFirst = (permute(0) == previousLast);
+}
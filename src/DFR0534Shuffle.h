@@ -0,0 +1,63 @@
+/**
+ * Class: DFR0534Shuffle
+ *
+ * Description:
+ * Seeded shuffle without repeats for all files on a drive or in a directory
+ * of a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Shuffle.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/**@brief
+ * Class for playing files of a DFR0534 audio module in a seeded random order
+ */
+class DFR0534Shuffle {
+  public:
+    /**@brief
+     * Constructor of a shuffle
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534Shuffle(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+    }
+    bool begin(unsigned long seed, bool directory=false);
+    word getFileNumber(word index);
+    word getIndex();
+    unsigned long getSeed();
+    word getTotal();
+    bool next();
+    bool play();
+    bool resume(unsigned long seed, word index, bool directory=false);
+    void stop();
+    void tick();
+  private:
+    unsigned long mix(unsigned long value, byte number);
+    void nextCycle();
+    word permute(word index);
+    void updateBoundary();
+    unsigned long m_seed = 0;
+    word m_first = 0;
+    word m_total = 0;
+    word m_index = 0;
+    byte m_halfBits = 1;
+    bool m_swapFirst = false;
+    bool m_playing = false;
+    unsigned long m_playMS = 0;
+    unsigned long m_lastPollMS = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
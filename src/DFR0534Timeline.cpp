@@ -0,0 +1,281 @@
+/**
+ * Class: DFR0534Timeline
+ *
+ * Description:
+ * Cue timeline for show sequences on a DFR0534 audio module, which runs
+ * from a table in flash memory and follows the runtime of the audio file
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - The cue table stays in flash memory (PROGMEM, 8 bytes per cue). Only the next
+ *   cue is copied to RAM
+ * - The timeline clock starts with start() and runs with millis(). After an ACTIONPLAY
+ *   cue tick() reads the runtime, which the module sends every second, with
+ *   DFR0534::pollRuntime() and compares the audio position with the clock. Differences
+ *   above TIMELINETOLERANCEMS are corrected by half, so the cues follow the audio and
+ *   do not drift. Differences above TIMELINEMAXDRIFTMS (for example runtimes of an
+ *   inserted file) are ignored
+ * - tick() sends all due cues. The latency is the time from the cue time to the end
+ *   of the sent frame and depends on how often tick() is called and on other frames
+ *   blocking the serial connection. Cues are never sent early
+ * - ACTIONFADE, ACTIONDUCK and ACTIONRESTORE need a DFR0534Fader, whose tick() is
+ *   called by the sketch
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Timeline.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Timeline.h"
+
+// Differences between runtime and clock, which are not corrected
+#define TIMELINETOLERANCEMS 50
+// Differences between runtime and clock, which are ignored
+#define TIMELINEMAXDRIFTMS 2000
+
+/**@brief
+ * Get number of clock corrections by the runtime
+ *
+ * @returns Number of corrections
+ */
+word DFR0534Timeline::getCorrectionCount()
+{
+  return m_correctionCount;
+}
+
+/**@brief
+ * Get last difference between runtime and clock
+ *
+ * @returns Difference in ms (> 0 = audio is ahead of the clock)
+ */
+long DFR0534Timeline::getLastDriftMS()
+{
+  return m_lastDriftMS;
+}
+
+/**@brief
+ * Get time from cue time to the sent frame for the last cue
+ *
+ * @returns Latency in ms
+ */
+unsigned long DFR0534Timeline::getLastLatencyMS()
+{
+  return m_lastLatencyMS;
+}
+
+/**@brief
+ * Get maximum time from cue time to the sent frame of all cues
+ *
+ * @returns Latency in ms
+ */
+unsigned long DFR0534Timeline::getMaxLatencyMS()
+{
+  return m_maxLatencyMS;
+}
+
+/**@brief
+ * Get mean time from cue time to the sent frame of all cues
+ *
+ * @returns Latency in ms
+ */
+unsigned long DFR0534Timeline::getMeanLatencyMS()
+{
+  if (m_firedCount == 0) return 0;
+  return m_sumLatencyMS/m_firedCount;
+}
+
+/**@brief
+ * Get current time of the timeline
+ *
+ * @returns Time since start() in ms (0 = not running)
+ */
+unsigned long DFR0534Timeline::getPosition()
+{
+  if (!m_running) return 0;
+  return clock(millis());
+}
+
+/**@brief
+ * Checks whether cues are waiting
+ *
+ * @retval true  Timeline is running
+ * @retval false All cues sent or stopped
+ */
+bool DFR0534Timeline::isRunning()
+{
+  return m_running;
+}
+
+/**@brief
+ * Start a timeline
+ *
+ * Cues at time 0 are sent by the next tick(). Starts receiving the runtime
+ * with DFR0534::startSendingRuntime(). When the runtime was not sent before,
+ * DFR0534::stopSendingRuntime() is called by stop() or after the last cue.
+ *
+ * @param[in] cues   Table of cues sorted by time (stored in flash memory with PROGMEM)
+ * @param[in] count  Number of cues
+ *
+ * @retval true  Timeline started
+ * @retval false Invalid table
+ */
+bool DFR0534Timeline::start(const DFR0534CUE *cues, word count)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  if ((cues == NULL) || (count == 0)) return false;
+  m_cues = cues;
+  m_count = count;
+  m_index = 0;
+  m_offsetMS = 0;
+  m_anchored = false;
+  m_pausePositionMS = 0;
+  m_lastDriftMS = 0;
+  m_correctionCount = 0;
+  m_lastLatencyMS = 0;
+  m_maxLatencyMS = 0;
+  m_sumLatencyMS = 0;
+  m_firedCount = 0;
+  load();
+  // Keep the state from before the first start(), when a running timeline is restarted
+  if (!m_running) m_wasSendingRuntime = m_ptrAudio->isSendingRuntime();
+  if (!m_ptrAudio->isSendingRuntime()) m_ptrAudio->startSendingRuntime();
+  m_runtimeMS = m_ptrAudio->getLastRuntimeMS();
+  m_startMS = millis();
+  m_running = true;
+  return true;
+}
+
+/**@brief
+ * Stop the timeline
+ *
+ * Remaining cues are not sent. The audio module is not stopped.
+ */
+void DFR0534Timeline::stop()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (m_running) finish();
+}
+
+/**@brief
+ * Follow the runtime and send due cues
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Timeline::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (!m_running) return;
+
+  byte hour, minute, second;
+  m_ptrAudio->pollRuntime(hour, minute, second);
+  if (m_ptrAudio->getLastRuntimeMS() != m_runtimeMS) {
+    // New runtime received
+    m_runtimeMS = m_ptrAudio->getLastRuntimeMS();
+    if (m_anchored && (m_pausePositionMS == 0)) {
+      long driftMS = (long)(m_playPositionMS+m_ptrAudio->getLastRuntime()*1000UL)-(long)clock(m_runtimeMS);
+      if (abs(driftMS) <= TIMELINEMAXDRIFTMS) {
+        m_lastDriftMS = driftMS;
+        if (abs(driftMS) > TIMELINETOLERANCEMS) {
+          m_offsetMS += driftMS/2;
+          m_correctionCount++;
+        }
+      }
+    }
+  }
+
+  while (m_running && ((long)(clock(millis())-m_next.timeMS) >= 0)) {
+    fire(m_next);
+    unsigned long latencyMS = clock(millis())-m_next.timeMS;
+    m_lastLatencyMS = latencyMS;
+    if (latencyMS > m_maxLatencyMS) m_maxLatencyMS = latencyMS;
+    m_sumLatencyMS += latencyMS;
+    m_firedCount++;
+    m_index++;
+    if (m_index < m_count) load(); else finish();
+  }
+}
+
+/**@brief
+ * Get time of the timeline
+ *
+ * @param[in] nowMS  millis() timestamp
+ *
+ * @returns Time since start() in ms including the corrections
+ */
+unsigned long DFR0534Timeline::clock(unsigned long nowMS)
+{
+  long position = (long)(nowMS-m_startMS)+m_offsetMS;
+  return (position < 0) ? 0 : position;
+}
+
+/**@brief
+ * End the timeline and restore the runtime sending state from before start()
+ */
+void DFR0534Timeline::finish()
+{
+  m_running = false;
+  if (!m_wasSendingRuntime) m_ptrAudio->stopSendingRuntime();
+}
+
+/**@brief
+ * Send a cue
+ *
+ * @param[in] cue  Cue
+ */
+void DFR0534Timeline::fire(DFR0534CUE &cue)
+{
+  switch (cue.action) {
+    case ACTIONPLAY:
+      m_ptrAudio->playFileByNumber(cue.value);
+      // Runtimes of the new file are relative to this time
+      m_playPositionMS = clock(millis());
+      m_pausePositionMS = 0;
+      m_anchored = true;
+      break;
+    case ACTIONINSERT:
+      m_ptrAudio->insertFileByNumber(cue.value, cue.parameter);
+      break;
+    case ACTIONSTOP:
+      m_ptrAudio->stop();
+      m_anchored = false;
+      break;
+    case ACTIONPAUSE:
+      m_ptrAudio->pause();
+      m_pausePositionMS = clock(millis());
+      break;
+    case ACTIONCONTINUE:
+      m_ptrAudio->play();
+      // The audio position has not moved during the pause
+      if (m_pausePositionMS > 0) m_playPositionMS += clock(millis())-m_pausePositionMS;
+      m_pausePositionMS = 0;
+      break;
+    case ACTIONVOLUME:
+      m_ptrAudio->setVolume(cue.parameter);
+      break;
+    case ACTIONEQUALIZER:
+      m_ptrAudio->setEqualizer(cue.parameter);
+      break;
+    case ACTIONFADE:
+      if (m_ptrFader != NULL) m_ptrFader->fadeTo(cue.parameter, cue.value);
+      break;
+    case ACTIONDUCK:
+      if (m_ptrFader != NULL) m_ptrFader->duck(cue.parameter, cue.value);
+      break;
+    case ACTIONRESTORE:
+      if (m_ptrFader != NULL) m_ptrFader->restore(cue.value);
+      break;
+  }
+}
+
+/**@brief
+ * Copy the cue at m_index from flash memory
+ */
+void DFR0534Timeline::load()
+{
+  memcpy_P(&m_next, &m_cues[m_index], sizeof(DFR0534CUE));
+}
@@ -0,0 +1,99 @@
+/**
+ * Class: DFR0534Timeline
+ *
+ * Description:
+ * Cue timeline for show sequences on a DFR0534 audio module, which runs
+ * from a table in flash memory and follows the runtime of the audio file
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Timeline.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+#include "DFR0534Fader.h"
+
+/**@brief
+ * Class for running time coded cues on a DFR0534 audio module
+ */
+class DFR0534Timeline {
+  public:
+    /** Cue actions */
+    enum DFR0534ACTION
+    {
+      ACTIONPLAY, /**< DFR0534::playFileByNumber() with file number value */
+      ACTIONINSERT, /**< DFR0534::insertFileByNumber() with file number value from the drive in parameter */
+      ACTIONSTOP, /**< DFR0534::stop() */
+      ACTIONPAUSE, /**< DFR0534::pause() */
+      ACTIONCONTINUE, /**< DFR0534::play() */
+      ACTIONVOLUME, /**< DFR0534::setVolume() with level in parameter */
+      ACTIONEQUALIZER, /**< DFR0534::setEqualizer() with mode in parameter */
+      ACTIONFADE, /**< DFR0534Fader::fadeTo() with level in parameter and duration in ms in value */
+      ACTIONDUCK, /**< DFR0534Fader::duck() with level in parameter and duration in ms in value */
+      ACTIONRESTORE, /**< DFR0534Fader::restore() with duration in ms in value */
+      ACTIONUNKNOWN /**< Unknown */
+    };
+    /** Cue in the timeline table (stored in flash memory with PROGMEM) */
+    struct DFR0534CUE
+    {
+      unsigned long timeMS; /**< Time since start() in ms (ascending) */
+      byte action; /**< Action like DFR0534Timeline::ACTIONPLAY */
+      byte parameter; /**< Level, mode or drive */
+      word value; /**< File number or duration in ms */
+    };
+    /**@brief
+     * Constructor of a cue timeline
+     *
+     * @param[in] audio  DFR0534 audio module
+     * @param[in] fader  Optional volume fader for ACTIONFADE, ACTIONDUCK and ACTIONRESTORE, NULL = no fader
+     */
+    DFR0534Timeline(DFR0534 &audio, DFR0534Fader *fader=NULL)
+    {
+      m_ptrAudio = &audio;
+      m_ptrFader = fader;
+    }
+    word getCorrectionCount();
+    long getLastDriftMS();
+    unsigned long getLastLatencyMS();
+    unsigned long getMaxLatencyMS();
+    unsigned long getMeanLatencyMS();
+    unsigned long getPosition();
+    bool isRunning();
+    bool start(const DFR0534CUE *cues, word count);
+    void stop();
+    void tick();
+  private:
+    unsigned long clock(unsigned long nowMS);
+    void finish();
+    void fire(DFR0534CUE &cue);
+    void load();
+    const DFR0534CUE *m_cues = NULL;
+    word m_count = 0;
+    word m_index = 0;
+    DFR0534CUE m_next;
+    bool m_running = false;
+    bool m_wasSendingRuntime = false;
+    unsigned long m_startMS = 0;
+    long m_offsetMS = 0;
+    bool m_anchored = false;
+    unsigned long m_playPositionMS = 0;
+    unsigned long m_pausePositionMS = 0;
+    unsigned long m_runtimeMS = 0;
+    long m_lastDriftMS = 0;
+    word m_correctionCount = 0;
+    unsigned long m_lastLatencyMS = 0;
+    unsigned long m_maxLatencyMS = 0;
+    unsigned long m_sumLatencyMS = 0;
+    word m_firedCount = 0;
+    DFR0534 *m_ptrAudio = NULL;
+    DFR0534Fader *m_ptrFader = NULL;
+};
@@ -0,0 +1,336 @@
+/**
+ * Class: DFR0534Trace, DFR0534TraceReplay
+ *
+ * Description:
+ * Recorder for the serial communication with a DFR0534 audio module and
+ * replayer for recorded traces
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Trace format (written by dump()):
+ * - 4 bytes "DFRT"
+ * - 1 byte format version (DFR0534TRACEVERSION)
+ * - Records from the oldest to the newest byte:
+ *   - 1 byte header: Bit 7 = direction (0 = sent to module, 1 = received from module),
+ *     bits 0-6 = ms since previous record (0-126)
+ *   - When bits 0-6 are 127: 2 bytes ms since previous record (big endian, 65535 = 65535 or more)
+ *   - 1 byte data
+ *
+ * A record needs 2 bytes (4 bytes after a pause of 127ms or more). When the
+ * ring buffer is full, the oldest records are dropped.
+ * Use extras/tools/dfr0534trace.cpp to decode a dumped trace on Linux.
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Trace.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Trace.h"
+
+#define TRACEDIRECTIONBIT 0x80
+#define TRACEDELTAMASK 0x7F
+#define TRACELONGDELTA 0x7F
+#define TRACEHEADERLENGTH 5 // "DFRT"+version
+
+/**@brief
+ * Remove all records
+ */
+void DFR0534Trace::clear()
+{
+  m_head = 0;
+  m_tail = 0;
+  m_used = 0;
+  m_droppedCount = 0;
+}
+
+/**@brief
+ * Write trace in binary format to an output, for example Serial
+ *
+ * @param[in] output  Output for the trace
+ */
+void DFR0534Trace::dump(Print &output)
+{
+  output.write((const uint8_t *)"DFRT", 4);
+  output.write((byte)DFR0534TRACEVERSION);
+  word index = m_tail;
+  for (word i=0;i<m_used;i++) {
+    output.write(m_buffer[index]);
+    index = (index+1) % m_size;
+  }
+}
+
+/**@brief
+ * Get number of records dropped, because the ring buffer was full
+ *
+ * @returns Number of dropped records
+ */
+unsigned long DFR0534Trace::getDroppedCount()
+{
+  return m_droppedCount;
+}
+
+/**@brief
+ * Get used bytes in the ring buffer
+ *
+ * dump() writes this number of bytes plus a 5 byte header
+ *
+ * @returns Used bytes
+ */
+word DFR0534Trace::getLength()
+{
+  return m_used;
+}
+
+/**@brief
+ * Start or stop recording
+ *
+ * @param[in] enabled  true = Record (=default), false = Pause recording
+ */
+void DFR0534Trace::setEnabled(bool enabled)
+{
+  m_enabled = enabled;
+}
+
+/**@brief
+ * Number of bytes available for reading from the serial connection
+ *
+ * @returns Number of bytes
+ */
+int DFR0534Trace::available()
+{
+  if (m_ptrStream == NULL) return 0; // Should not happen
+  return m_ptrStream->available();
+}
+
+/**@brief
+ * Wait until all bytes are sent
+ */
+void DFR0534Trace::flush()
+{
+  if (m_ptrStream == NULL) return; // Should not happen
+  m_ptrStream->flush();
+}
+
+/**@brief
+ * Get next received byte without removing it (not recorded)
+ *
+ * @returns Byte or -1, when no byte is available
+ */
+int DFR0534Trace::peek()
+{
+  if (m_ptrStream == NULL) return -1; // Should not happen
+  return m_ptrStream->peek();
+}
+
+/**@brief
+ * Read and record next received byte
+ *
+ * @returns Byte or -1, when no byte is available
+ */
+int DFR0534Trace::read()
+{
+  if (m_ptrStream == NULL) return -1; // Should not happen
+  int data = m_ptrStream->read();
+  if (data >= 0) record(DIRECTIONRX, data);
+  return data;
+}
+
+/**@brief
+ * Record and send byte
+ *
+ * @param[in] data  Byte to send
+ *
+ * @returns Number of sent bytes
+ */
+size_t DFR0534Trace::write(uint8_t data)
+{
+  if (m_ptrStream == NULL) return 0; // Should not happen
+  record(DIRECTIONTX, data);
+  return m_ptrStream->write(data);
+}
+
+/**@brief
+ * Add record to the ring buffer and drop oldest records, when the ring buffer is full
+ *
+ * @param[in] direction  DFR0534Trace::DIRECTIONTX or DFR0534Trace::DIRECTIONRX
+ * @param[in] data       Byte
+ */
+void DFR0534Trace::record(byte direction, byte data)
+{
+  if (!m_enabled) return;
+  if (m_size < 4) return;
+
+  unsigned long nowMS = millis();
+  unsigned long deltaMS = (m_used == 0) ? 0 : nowMS-m_lastMS;
+  m_lastMS = nowMS;
+  byte length = (deltaMS < TRACELONGDELTA) ? 2 : 4;
+
+  while (m_size-m_used < length) {
+    // Drop oldest record
+    byte oldLength = ((m_buffer[m_tail] & TRACEDELTAMASK) == TRACELONGDELTA) ? 4 : 2;
+    m_tail = (m_tail+oldLength) % m_size;
+    m_used -= oldLength;
+    m_droppedCount++;
+  }
+
+  byte header = (direction == DIRECTIONRX) ? TRACEDIRECTIONBIT : 0;
+  if (length == 2) {
+    push(header | deltaMS);
+  } else {
+    if (deltaMS > 0xffff) deltaMS = 0xffff;
+    push(header | TRACELONGDELTA);
+    push((deltaMS >> 8) & 0xff);
+    push(deltaMS & 0xff);
+  }
+  push(data);
+}
+
+/**@brief
+ * Get number of sent bytes, which differ from the recorded trace
+ *
+ * @returns Number of mismatches
+ */
+word DFR0534TraceReplay::getMismatchCount()
+{
+  return m_mismatchCount;
+}
+
+/**@brief
+ * Checks whether all records were replayed
+ *
+ * @retval true  All records replayed
+ * @retval false Records left
+ */
+bool DFR0534TraceReplay::isFinished()
+{
+  return m_position >= m_length;
+}
+
+/**@brief
+ * Restart replay with the first record
+ */
+void DFR0534TraceReplay::rewind()
+{
+  m_position = TRACEHEADERLENGTH;
+  m_mismatchCount = 0;
+  m_lastEventMS = now();
+  // Invalid header => Nothing to replay
+  if ((m_length < TRACEHEADERLENGTH) || (memcmp(m_trace, "DFRT", 4) != 0) || (m_trace[4] != DFR0534TRACEVERSION)) m_position = m_length;
+}
+
+/**@brief
+ * Set the clock for the recorded times
+ *
+ * Allows replaying a trace faster, slower or step by step, for example in a test on a PC
+ *
+ * @param[in] clock  Function returning the time in ms (NULL = millis(), =default)
+ */
+void DFR0534TraceReplay::setClock(unsigned long (*clock)())
+{
+  m_clock = clock;
+  m_lastEventMS = now();
+}
+
+/**@brief
+ * Number of received bytes available, when the recorded time has elapsed
+ *
+ * @returns 1 when a received byte is due, otherwise 0
+ */
+int DFR0534TraceReplay::available()
+{
+  byte direction, data;
+  unsigned long deltaMS;
+  word length;
+  if (!nextRecord(direction, deltaMS, data, length)) return 0;
+  if (direction != DFR0534Trace::DIRECTIONRX) return 0;
+  if (now()-m_lastEventMS < deltaMS) return 0;
+  return 1;
+}
+
+/**@brief
+ * Get next due received byte without removing it
+ *
+ * @returns Byte or -1, when no byte is due
+ */
+int DFR0534TraceReplay::peek()
+{
+  byte direction, data;
+  unsigned long deltaMS;
+  word length;
+  if (available() == 0) return -1;
+  if (!nextRecord(direction, deltaMS, data, length)) return -1;
+  return data;
+}
+
+/**@brief
+ * Read next due received byte
+ *
+ * @returns Byte or -1, when no byte is due
+ */
+int DFR0534TraceReplay::read()
+{
+  byte direction, data;
+  unsigned long deltaMS;
+  word length;
+  if (available() == 0) return -1;
+  if (!nextRecord(direction, deltaMS, data, length)) return -1;
+  m_position += length;
+  m_lastEventMS = now();
+  return data;
+}
+
+/**@brief
+ * Compare sent byte with the next recorded sent byte
+ *
+ * @param[in] data  Byte to send
+ *
+ * @returns 1
+ */
+size_t DFR0534TraceReplay::write(uint8_t data)
+{
+  byte direction, recordedData;
+  unsigned long deltaMS;
+  word length;
+  if (!nextRecord(direction, deltaMS, recordedData, length) || (direction != DFR0534Trace::DIRECTIONTX)) {
+    // Not expected at this position
+    m_mismatchCount++;
+    return 1;
+  }
+  if (recordedData != data) m_mismatchCount++;
+  m_position += length;
+  m_lastEventMS = now();
+  return 1;
+}
+
+/**@brief
+ * Decode record at the current position
+ *
+ * @param[out] direction  DFR0534Trace::DIRECTIONTX or DFR0534Trace::DIRECTIONRX
+ * @param[out] deltaMS    ms since previous record
+ * @param[out] data       Byte
+ * @param[out] length     Length of the record in bytes
+ *
+ * @retval true  Record decoded
+ * @retval false No more records
+ */
+bool DFR0534TraceReplay::nextRecord(byte &direction, unsigned long &deltaMS, byte &data, word &length)
+{
+  if (m_position+2 > m_length) return false;
+  byte header = m_trace[m_position];
+  direction = (header & TRACEDIRECTIONBIT) ? DFR0534Trace::DIRECTIONRX : DFR0534Trace::DIRECTIONTX;
+  if ((header & TRACEDELTAMASK) == TRACELONGDELTA) {
+    if (m_position+4 > m_length) return false;
+    deltaMS = ((unsigned long)m_trace[m_position+1] << 8) | m_trace[m_position+2];
+    data = m_trace[m_position+3];
+    length = 4;
+  } else {
+    deltaMS = header & TRACEDELTAMASK;
+    data = m_trace[m_position+1];
+    length = 2;
+  }
+  return true;
+}
@@ -0,0 +1,122 @@
+/**
+ * Class: DFR0534Trace, DFR0534TraceReplay
+ *
+ * Description:
+ * Recorder for the serial communication with a DFR0534 audio module and
+ * replayer for recorded traces
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Trace.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <Stream.h>
+
+/** Trace format version written by DFR0534Trace::dump() */
+#define DFR0534TRACEVERSION 1
+
+/**@brief
+ * Stream between the DFR0534 class and SoftwareSerial/HardwareSerial, which records all bytes in a ring buffer
+ */
+class DFR0534Trace : public Stream {
+  public:
+    /** Directions */
+    enum DFR0534DIRECTION
+    {
+      DIRECTIONTX, /**< Byte sent to the audio module */
+      DIRECTIONRX /**< Byte received from the audio module */
+    };
+    /**@brief
+     * Constructor of a trace recorder
+     *
+     * @param[in] stream  Serial connection object, like SoftwareSerial or HardwareSerial
+     * @param[in] buffer  Memory for the ring buffer (at least 4 bytes)
+     * @param[in] size    Size of the ring buffer in bytes
+     */
+    DFR0534Trace(Stream &stream, byte *buffer, word size)
+    {
+      m_ptrStream = &stream;
+      m_buffer = buffer;
+      m_size = (buffer == NULL) ? 0 : size;
+    }
+    void clear();
+    void dump(Print &output);
+    unsigned long getDroppedCount();
+    word getLength();
+    void setEnabled(bool enabled);
+    // Stream interface
+    int available();
+    void flush();
+    int peek();
+    int read();
+    size_t write(uint8_t data);
+    using Print::write;
+  private:
+    void record(byte direction, byte data);
+    void push(byte data) {
+      m_buffer[m_head] = data;
+      m_head = (m_head+1) % m_size;
+      m_used++;
+    }
+    Stream *m_ptrStream = NULL;
+    byte *m_buffer = NULL;
+    word m_size = 0;
+    word m_head = 0;
+    word m_tail = 0;
+    word m_used = 0;
+    unsigned long m_lastMS = 0;
+    unsigned long m_droppedCount = 0;
+    bool m_enabled = true;
+};
+
+/**@brief
+ * Stream, which plays a recorded trace back to the DFR0534 class
+ *
+ * Received bytes are returned in the recorded order and not before
+ * the recorded time since the previous byte has elapsed.
+ * Sent bytes are compared with the recorded bytes.
+ */
+class DFR0534TraceReplay : public Stream {
+  public:
+    /**@brief
+     * Constructor of a trace replayer
+     *
+     * @param[in] trace   Trace as written by DFR0534Trace::dump()
+     * @param[in] length  Length of the trace in bytes
+     */
+    DFR0534TraceReplay(const byte *trace, word length)
+    {
+      m_trace = trace;
+      m_length = (trace == NULL) ? 0 : length;
+      rewind();
+    }
+    word getMismatchCount();
+    bool isFinished();
+    void rewind();
+    void setClock(unsigned long (*clock)());
+    // Stream interface
+    int available();
+    void flush() {}
+    int peek();
+    int read();
+    size_t write(uint8_t data);
+    using Print::write;
+  private:
+    bool nextRecord(byte &direction, unsigned long &deltaMS, byte &data, word &length);
+    unsigned long now() { return (m_clock == NULL) ? millis() : m_clock(); }
+    const byte *m_trace = NULL;
+    word m_length = 0;
+    word m_position = 0;
+    unsigned long m_lastEventMS = 0;
+    word m_mismatchCount = 0;
+    unsigned long (*m_clock)() = NULL;
+};
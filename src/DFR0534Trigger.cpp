@@ -0,0 +1,233 @@
+/**
+ * Class: DFR0534Trigger
+ *
+ * Description:
+ * Low latency trigger for sound effects, which keeps the next effect prepared
+ * on a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - The module can only prepare one file at a time. arm() sets this standby file and
+ *   selects it with DFR0534::prepareFileByNumber(). After every effect the standby file
+ *   is prepared again
+ * - fire() only sets a flag and can be called from an interrupt service routine.
+ *   Sending from an ISR is not safe with SoftwareSerial or a full HardwareSerial buffer,
+ *   so tick() sends the frame. Call tick() as often as possible to keep the latency low
+ * - Firing the prepared file needs only the 4 byte DFR0534::play() frame, without
+ *   selecting and opening a file. Other files are played with DFR0534::playFileByNumber()
+ * - In benchmark mode tick() waits after firing until DFR0534::getStatus() returns
+ *   DFR0534::PLAYING and stores the time since fire() (resolution is about one
+ *   status request, 10ms at 9600 baud)
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Trigger.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Trigger.h"
+
+// Interval for checking whether the effect has finished
+#define TRIGGERPOLLMS 250
+// Time the audio module needs to start a file
+#define TRIGGERSTARTUPMS 500
+// Maximum wait time for DFR0534::PLAYING in benchmark mode
+#define TRIGGERBENCHMARKTIMEOUTMS 2000
+// Time the audio module needs to prepare a file in measure()
+#define TRIGGERPREPAREMS 500
+
+/**@brief
+ * Set standby file, which is prepared for the next fire()
+ *
+ * The file is prepared immediately, when no effect is playing,
+ * otherwise after the running effect
+ *
+ * @param[in] track  File number (0 = no standby file)
+ *
+ * @retval true  Standby file set
+ * @retval false Invalid file number
+ */
+bool DFR0534Trigger::arm(word track)
+{
+  if (m_ptrAudio == NULL) return false; // Should not happen
+  m_standbyTrack = track;
+  m_armed = false;
+  if ((track > 0) && !m_playing) {
+    m_ptrAudio->prepareFileByNumber(track);
+    m_armed = true;
+  }
+  return true;
+}
+
+/**@brief
+ * Trigger an effect (ISR safe)
+ *
+ * The frame is sent by the next tick()
+ *
+ * @param[in] track  File number (0 = standby file set by arm())
+ */
+void DFR0534Trigger::fire(word track)
+{
+  m_fireTrack = track;
+  m_fireUS = micros();
+  m_fired = true;
+}
+
+/**@brief
+ * Get number of effects started from the prepared file
+ *
+ * @returns Number of effects
+ */
+word DFR0534Trigger::getArmedCount()
+{
+  return m_armedCount;
+}
+
+/**@brief
+ * Get number of effects started by tick()
+ *
+ * @returns Number of effects
+ */
+word DFR0534Trigger::getFireCount()
+{
+  return m_fireCount;
+}
+
+/**@brief
+ * Get time from the last fire() to DFR0534::PLAYING (only in benchmark mode)
+ *
+ * @returns Latency in us (0 = not measured or timeout)
+ */
+unsigned long DFR0534Trigger::getLastLatencyUS()
+{
+  return m_lastLatencyUS;
+}
+
+/**@brief
+ * Get maximum time from fire() to DFR0534::PLAYING (only in benchmark mode)
+ *
+ * @returns Latency in us
+ */
+unsigned long DFR0534Trigger::getMaxLatencyUS()
+{
+  return m_maxLatencyUS;
+}
+
+/**@brief
+ * Checks whether the standby file is prepared
+ *
+ * @retval true  Next fire() only sends DFR0534::play()
+ * @retval false No file prepared
+ */
+bool DFR0534Trigger::isArmed()
+{
+  return m_armed;
+}
+
+/**@brief
+ * Measure the time from sending to DFR0534::PLAYING for a file
+ *
+ * Blocks up to about 3 seconds. Stops the running file first. Use it to compare
+ * the prepared path with the DFR0534::playFileByNumber() path.
+ *
+ * @param[in] track  File number
+ * @param[in] armed  true = Prepare the file and send DFR0534::play(), false = Send DFR0534::playFileByNumber()
+ *
+ * @returns Latency in us (0 = timeout)
+ */
+unsigned long DFR0534Trigger::measure(word track, bool armed)
+{
+  if (m_ptrAudio == NULL) return 0; // Should not happen
+  if (track <= 0) return 0;
+  m_ptrAudio->stop();
+  m_armed = false;
+  if (armed) {
+    m_ptrAudio->prepareFileByNumber(track);
+    delay(TRIGGERPREPAREMS);
+  }
+  unsigned long startUS = micros();
+  if (armed) m_ptrAudio->play(); else m_ptrAudio->playFileByNumber(track);
+  m_playing = true;
+  m_playMS = millis();
+  m_lastPollMS = m_playMS;
+  return waitPlaying(startUS);
+}
+
+/**@brief
+ * Enable or disable benchmark mode
+ *
+ * @param[in] enabled  true = Measure latency after each fire(), false = No measurement (=default)
+ */
+void DFR0534Trigger::setBenchmark(bool enabled)
+{
+  m_benchmark = enabled;
+}
+
+/**@brief
+ * Send fired effects and prepare the standby file after an effect
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Trigger::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+
+  if (m_fired) {
+    noInterrupts();
+    word track = m_fireTrack;
+    unsigned long fireUS = m_fireUS;
+    m_fired = false;
+    interrupts();
+
+    if (track == 0) track = m_standbyTrack;
+    if (track > 0) {
+      if (m_armed && (track == m_standbyTrack)) {
+        m_ptrAudio->play();
+        m_armedCount++;
+      } else m_ptrAudio->playFileByNumber(track);
+      m_armed = false;
+      m_playing = true;
+      m_playMS = millis();
+      m_lastPollMS = m_playMS;
+      m_fireCount++;
+      if (m_benchmark) {
+        m_lastLatencyUS = waitPlaying(fireUS);
+        if (m_lastLatencyUS > m_maxLatencyUS) m_maxLatencyUS = m_lastLatencyUS;
+      }
+    }
+  }
+
+  if (m_playing) {
+    unsigned long nowMS = millis();
+    if (nowMS-m_playMS < TRIGGERSTARTUPMS) return;
+    if (nowMS-m_lastPollMS < TRIGGERPOLLMS) return;
+    m_lastPollMS = nowMS;
+    if (m_ptrAudio->getStatus() != DFR0534::STOPPED) return; // Still playing or try again later
+    m_playing = false;
+  }
+
+  if (!m_armed && (m_standbyTrack > 0)) {
+    m_ptrAudio->prepareFileByNumber(m_standbyTrack);
+    m_armed = true;
+  }
+}
+
+/**@brief
+ * Wait until the audio module is playing
+ *
+ * @param[in] startUS  micros() timestamp of the trigger
+ *
+ * @returns Time since startUS in us (0 = timeout)
+ */
+unsigned long DFR0534Trigger::waitPlaying(unsigned long startUS)
+{
+  unsigned long startMS = millis();
+  while (millis()-startMS < TRIGGERBENCHMARKTIMEOUTMS) {
+    if (m_ptrAudio->getStatus() == DFR0534::PLAYING) return micros()-startUS;
+  }
+  return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * Class: DFR0534Trigger
+ *
+ * Description:
+ * Low latency trigger for sound effects, which keeps the next effect prepared
+ * on a DFR0534 audio module
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Trigger.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/**@brief
+ * Class for triggering sound effects with a prepared file on a DFR0534 audio module
+ */
+class DFR0534Trigger {
+  public:
+    /**@brief
+     * Constructor of a trigger
+     *
+     * @param[in] audio  DFR0534 audio module
+     */
+    DFR0534Trigger(DFR0534 &audio)
+    {
+      m_ptrAudio = &audio;
+    }
+    bool arm(word track);
+    void fire(word track=0);
+    word getArmedCount();
+    word getFireCount();
+    unsigned long getLastLatencyUS();
+    unsigned long getMaxLatencyUS();
+    bool isArmed();
+    unsigned long measure(word track, bool armed);
+    void setBenchmark(bool enabled);
+    void tick();
+  private:
+    unsigned long waitPlaying(unsigned long startUS);
+    volatile bool m_fired = false;
+    volatile word m_fireTrack = 0;
+    volatile unsigned long m_fireUS = 0;
+    word m_standbyTrack = 0;
+    bool m_armed = false;
+    bool m_playing = false;
+    bool m_benchmark = false;
+    unsigned long m_playMS = 0;
+    unsigned long m_lastPollMS = 0;
+    unsigned long m_lastLatencyUS = 0;
+    unsigned long m_maxLatencyUS = 0;
+    word m_fireCount = 0;
+    word m_armedCount = 0;
+    DFR0534 *m_ptrAudio = NULL;
+};
@@ -0,0 +1,268 @@
+/**
+ * Class: DFR0534Watchdog
+ *
+ * Description:
+ * Health monitor for a DFR0534 audio module, which restores settings and playback after a restart
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Notes:
+ * - After a power cycle the audio module starts with volume 20, EQ DFR0534::NORMAL,
+ *   loop mode DFR0534::SINGLEAUDIOSTOP and does not play
+ * - The watchdog requests the status every poll interval (default 1s) and
+ *   starts a recovery, when
+ *   - the module did not answer for several requests in a row (default 3), where a
+ *     missing file number while playing or paused counts as no answer, or
+ *   - the module stopped playing before the end of the current file, although
+ *     no command was sent to the module since the last poll
+ * - A recovery calls the optional power cycle function, waits until the module
+ *   answers again and restores the settings with DFR0534::restoreSettings()
+ *   and the file with playFileByNumber(). The playback position is restored with
+ *   fastForwardDuration(), which tick() sends WATCHDOGSTARTUPMS later, when the module
+ *   has started the file
+ * - The playback position is estimated by the time the module was found playing
+ *   and has an accuracy of about one poll interval
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Watchdog.cpp
+ * @version 1.0.4
+ */
+#include "DFR0534Watchdog.h"
+
+// Interval for requesting the status while waiting for the restarted module
+#define WATCHDOGBOOTPOLLMS 100
+// Maximum time to wait for the restarted module
+#define WATCHDOGBOOTTIMEOUTMS 3000
+// A stop within this time before the end of the file is treated as regular end of file
+#define WATCHDOGENDTOLERANCEMS 2000
+// Time the audio module needs to start a file before fastForwardDuration() works
+#define WATCHDOGSTARTUPMS 100
+
+/**@brief
+ * Get number of recoveries, where the audio module did not answer again
+ *
+ * @returns Number of failed recoveries
+ */
+word DFR0534Watchdog::getFailedCount()
+{
+  return m_failedCount;
+}
+
+/**@brief
+ * Get duration of the last successful recovery
+ *
+ * Time from detecting the failure until the settings and playback were restored
+ *
+ * @returns Duration in ms
+ */
+unsigned long DFR0534Watchdog::getLastRecoveryMS()
+{
+  return m_lastRecoveryMS;
+}
+
+/**@brief
+ * Get number of frames sent to restore settings and playback in the last successful recovery
+ *
+ * @returns Number of frames
+ */
+byte DFR0534Watchdog::getLastRecoveryFrames()
+{
+  return m_lastRecoveryFrames;
+}
+
+/**@brief
+ * Get number of successful recoveries
+ *
+ * @returns Number of recoveries
+ */
+word DFR0534Watchdog::getRecoveryCount()
+{
+  return m_recoveryCount;
+}
+
+/**@brief
+ * Checks whether a recovery is running
+ *
+ * @retval true  Recovery is running
+ * @retval false Monitoring
+ */
+bool DFR0534Watchdog::isRecovering()
+{
+  return m_recovering;
+}
+
+/**@brief
+ * Start a recovery
+ *
+ * Calls the power cycle function (when set). The settings and the playback
+ * are restored by tick(), when the audio module answers again.
+ */
+void DFR0534Watchdog::recover()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  if (m_recovering) return;
+  m_recovering = true;
+  m_seekPosition = 0;
+  m_recoveryStartMS = millis();
+  m_restoreTrack = m_lastTrack;
+  m_restorePositionSeconds = m_positionMS/1000;
+  m_restorePlaying = (m_lastStatus == DFR0534::PLAYING);
+  if (m_powerCycle != NULL) m_powerCycle();
+  m_lastPollMS = millis();
+}
+
+/**@brief
+ * Set interval for status requests
+ *
+ * @param[in] intervalMS  Interval in ms (default 1000)
+ */
+void DFR0534Watchdog::setPollInterval(unsigned long intervalMS)
+{
+  m_pollIntervalMS = intervalMS;
+}
+
+/**@brief
+ * Set number of unanswered status requests in a row, which start a recovery
+ *
+ * @param[in] timeouts  Number of unanswered requests (default 3)
+ */
+void DFR0534Watchdog::setTimeoutLimit(byte timeouts)
+{
+  if (timeouts == 0) timeouts = 1;
+  m_timeoutLimit = timeouts;
+}
+
+/**@brief
+ * Monitor audio module and run recovery
+ *
+ * Has to be called frequently, for example in loop()
+ */
+void DFR0534Watchdog::tick()
+{
+  if (m_ptrAudio == NULL) return; // Should not happen
+  unsigned long nowMS = millis();
+
+  if (m_recovering) {
+    if (nowMS-m_lastPollMS < WATCHDOGBOOTPOLLMS) return;
+    m_lastPollMS = nowMS;
+    if (m_ptrAudio->getStatus() != DFR0534::STATUSUNKNOWN) {
+      restore();
+      return;
+    }
+    if (millis()-m_recoveryStartMS > WATCHDOGBOOTTIMEOUTMS) {
+      // Module does not answer => Give up and try again after the next timeouts
+      m_recovering = false;
+      m_failedCount++;
+      m_timeouts = 0;
+      m_lastStatus = DFR0534::STATUSUNKNOWN;
+      m_expectedFrames = m_ptrAudio->getSentFrames();
+    }
+    return;
+  }
+
+  if (m_seekPosition > 0) {
+    // Delayed seek of the recovery
+    if (nowMS-m_seekStartMS < WATCHDOGSTARTUPMS) return;
+    m_ptrAudio->fastForwardDuration(m_seekPosition);
+    m_seekPosition = 0;
+    m_lastRecoveryFrames++;
+    m_lastRecoveryMS = millis()-m_recoveryStartMS;
+    m_expectedFrames = m_ptrAudio->getSentFrames();
+    return;
+  }
+
+  if (nowMS-m_lastPollMS < m_pollIntervalMS) return;
+  unsigned long elapsedMS = nowMS-m_lastPollMS;
+  m_lastPollMS = nowMS;
+
+  // Frames not sent by the watchdog => state changes could be caused by the user
+  bool userActivity = (m_ptrAudio->getSentFrames() != m_expectedFrames);
+
+  byte status = m_ptrAudio->getStatus();
+  word track = 0;
+  if ((status != DFR0534::STATUSUNKNOWN) && (status != DFR0534::STOPPED)) track = m_ptrAudio->getFileNumber();
+  // No status or no file number (getFileNumber() returns 0 on timeout) => Timeout
+  if ((status == DFR0534::STATUSUNKNOWN) || ((status != DFR0534::STOPPED) && (track == 0))) {
+    m_timeouts++;
+    if (m_timeouts >= m_timeoutLimit) recover();
+    else m_expectedFrames = m_ptrAudio->getSentFrames();
+    return;
+  }
+  m_timeouts = 0;
+
+  // Stopped before the end of the file without a command
+  if (!userActivity && (m_lastStatus == DFR0534::PLAYING) && (status == DFR0534::STOPPED) &&
+    (m_durationSeconds > 0) && (m_positionMS+elapsedMS+WATCHDOGENDTOLERANCEMS < (unsigned long)m_durationSeconds*1000)) {
+    recover();
+    return;
+  }
+
+  if (status == DFR0534::PLAYING) {
+    if (track != m_lastTrack) startPlaybackTracking(track);
+    else if (m_lastStatus == DFR0534::PLAYING) {
+      m_positionMS += elapsedMS;
+      // Restarted file, for example in loop mode DFR0534::SINGLEAUDIOLOOP
+      if ((m_durationSeconds > 0) && (m_positionMS >= (unsigned long)m_durationSeconds*1000)) m_positionMS -= (unsigned long)m_durationSeconds*1000;
+    }
+  }
+  if (status == DFR0534::STOPPED) {
+    m_lastTrack = 0;
+    m_positionMS = 0;
+  }
+  m_lastStatus = status;
+  m_expectedFrames = m_ptrAudio->getSentFrames();
+}
+
+/**@brief
+ * Reset playback position for a new file and request its duration
+ *
+ * @param[in] track  File number
+ */
+void DFR0534Watchdog::startPlaybackTracking(word track)
+{
+  byte hour, minute, second;
+  m_lastTrack = track;
+  m_positionMS = 0;
+  m_durationSeconds = 0;
+  if (track == 0) return;
+  if (m_ptrAudio->getDuration(hour, minute, second)) {
+    m_durationSeconds = (word)hour*3600+(word)minute*60+second;
+  }
+}
+
+/**@brief
+ * Restore settings and playback after the audio module answers again
+ */
+void DFR0534Watchdog::restore()
+{
+  word framesBefore = m_ptrAudio->getSentFrames();
+  m_ptrAudio->restoreSettings();
+  if (m_restorePlaying && (m_restoreTrack > 0)) {
+    m_ptrAudio->playFileByNumber(m_restoreTrack);
+    // Seek is sent by tick(), when the module has started the file
+    m_seekPosition = m_restorePositionSeconds;
+    m_seekStartMS = millis();
+  }
+  m_lastRecoveryFrames = m_ptrAudio->getSentFrames()-framesBefore;
+  m_lastRecoveryMS = millis()-m_recoveryStartMS;
+  m_recoveryCount++;
+
+  m_recovering = false;
+  m_timeouts = 0;
+  if (m_restorePlaying && (m_restoreTrack > 0)) {
+    m_lastStatus = DFR0534::PLAYING;
+    m_lastTrack = m_restoreTrack;
+    m_positionMS = (unsigned long)m_restorePositionSeconds*1000;
+  } else {
+    m_lastStatus = DFR0534::STOPPED;
+    m_lastTrack = 0;
+    m_positionMS = 0;
+  }
+  m_lastPollMS = millis();
+  m_expectedFrames = m_ptrAudio->getSentFrames();
+}
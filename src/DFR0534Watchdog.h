@@ -0,0 +1,75 @@
+/**
+ * Class: DFR0534Watchdog
+ *
+ * Description:
+ * Health monitor for a DFR0534 audio module, which restores settings and playback after a restart
+ *
+ * License: 2-Clause BSD License
+ * Copyright (c) 2024 codingABI
+ * For details see: LICENSE.txt
+ *
+ * Home: https://github.com/codingABI/DFR0534
+ *
+ * @author codingABI https://github.com/codingABI/
+ * @copyright 2-Clause BSD License
+ * @file DFR0534Watchdog.h
+ * @version 1.0.4
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "DFR0534.h"
+
+/**@brief
+ * Class for monitoring a DFR0534 audio module and restoring its state after a brown-out or power cycle
+ */
+class DFR0534Watchdog {
+  public:
+    /**@brief
+     * Constructor of a watchdog
+     *
+     * @param[in] audio       DFR0534 audio module to monitor
+     * @param[in] powerCycle  Optional function to switch the audio module off and on again (for example with a FET), NULL = no power cycle
+     */
+    DFR0534Watchdog(DFR0534 &audio, void (*powerCycle)()=NULL)
+    {
+      m_ptrAudio = &audio;
+      m_powerCycle = powerCycle;
+    }
+    word getFailedCount();
+    unsigned long getLastRecoveryMS();
+    byte getLastRecoveryFrames();
+    word getRecoveryCount();
+    bool isRecovering();
+    void recover();
+    void setPollInterval(unsigned long intervalMS);
+    void setTimeoutLimit(byte timeouts);
+    void tick();
+  private:
+    void restore();
+    void startPlaybackTracking(word track);
+    DFR0534 *m_ptrAudio = NULL;
+    void (*m_powerCycle)() = NULL;
+    bool m_recovering = false;
+    unsigned long m_pollIntervalMS = 1000;
+    byte m_timeoutLimit = 3;
+    byte m_timeouts = 0;
+    byte m_lastStatus = DFR0534::STATUSUNKNOWN;
+    word m_lastTrack = 0;
+    word m_durationSeconds = 0;
+    unsigned long m_positionMS = 0;
+    unsigned long m_lastPollMS = 0;
+    word m_expectedFrames = 0;
+    // State to restore
+    word m_restoreTrack = 0;
+    word m_restorePositionSeconds = 0;
+    bool m_restorePlaying = false;
+    word m_seekPosition = 0;
+    unsigned long m_seekStartMS = 0;
+    // Statistics
+    unsigned long m_recoveryStartMS = 0;
+    unsigned long m_lastRecoveryMS = 0;
+    byte m_lastRecoveryFrames = 0;
+    word m_recoveryCount = 0;
+    word m_failedCount = 0;
+};